@@ -20,6 +20,9 @@
 
 namespace {
 
+bool isStarted = false;
+LongTime _deadline;
+
 unsigned int compareValueForTimeout(OSTime timeout) {
 
 	OSTime beforeCounter = LongClock::osClockNowTime();
@@ -54,6 +57,10 @@ void EventTimer::start(OSTime timeout) {
 	compareRegisters[EVENT_TIMER_INDEX].set(compareValueForTimeout(timeout));
 
 	compareRegisters[EVENT_TIMER_INDEX].enableEventSignal();
+
+	// Only for reporting, not exact
+	_deadline = LongClock::nowTime() + timeout;
+	isStarted = true;
 }
 
 
@@ -61,6 +68,13 @@ void EventTimer::start(OSTime timeout) {
 void EventTimer::stop() {
 	compareRegisters[EVENT_TIMER_INDEX].disableEventSignal();
 	// Not change compare register value
+	isStarted = false;
+}
+
+
+bool EventTimer::deadline(LongTime& eventTime) {
+	if (isStarted) eventTime = _deadline;
+	return isStarted;
 }
 
 uint32_t* EventTimer::getEventRegisterAddress() {
@@ -3,6 +3,9 @@
 
 #include "../platformTypes.h"   // OSTime
 
+// embeddedMath
+#include <timeTypes.h>    // LongTime
+
 
 
 /*
@@ -15,4 +18,11 @@ public:
 	static void start(OSTime timeout);
 	static void stop();
 	static uint32_t* getEventRegisterAddress();
+
+	/*
+	 * Time of event of most recent start().
+	 * Returns false if stopped.  May be in the past (event already occurred.)
+	 * The event does not wake mcu (no interrupt.)
+	 */
+	static bool deadline(LongTime& eventTime);
 };
@@ -0,0 +1,119 @@
+
+#include "idleScheduler.h"
+
+#include "longClock.h"
+#include "taskTimer.h"
+#include "eventTimer.h"
+#include "mcuSleep.h"
+
+#include "../exceptions/powerAssertions.h"
+#include "../services/eventQueue.h"
+
+
+namespace {
+
+bool _isRadioWindowOpen = false;
+LongTime radioWindowEnd;
+
+// Statistics
+bool isMeasuring = false;
+LongTime lastWake;
+LongTime _timeAsleep = 0;
+LongTime _timeAwake = 0;
+uint32_t _countWakes = 0;
+
+
+/*
+ * Keep the earlier of candidate and result, ignoring candidates already past.
+ */
+void considerDeadline(LongTime candidate, LongTime now, bool& isAny, LongTime& result) {
+	if (candidate < now) return;
+	if ( (not isAny) or (candidate < result) ) {
+		result = candidate;
+		isAny = true;
+	}
+}
+
+}	// namespace
+
+
+
+void IdleScheduler::openRadioWindow(LongTime end) {
+	radioWindowEnd = end;
+	_isRadioWindowOpen = true;
+}
+
+void IdleScheduler::closeRadioWindow() { _isRadioWindowOpen = false; }
+
+bool IdleScheduler::isRadioWindowOpen() { return _isRadioWindowOpen; }
+
+
+bool IdleScheduler::nextDeadline(LongTime& deadline) {
+	LongTime now = LongClock::nowTime();
+	bool isAny = false;
+	LongTime candidate;
+
+	if (TaskTimer::nextWakeTime(candidate)) {
+		// A due Task is pended already, its deadline is effectively now
+		considerDeadline((candidate < now) ? now : candidate, now, isAny, deadline);
+	}
+	if (EventTimer::deadline(candidate)) {
+		considerDeadline(candidate, now, isAny, deadline);
+	}
+	if (_isRadioWindowOpen) {
+		considerDeadline(radioWindowEnd, now, isAny, deadline);
+	}
+	return isAny;
+}
+
+
+void IdleScheduler::sleepUntilNextDeadline() {
+
+	/*
+	 * Run-to-completion work first.
+	 * An ISR may post more after this check, but that ISR's interrupt sets the ARM EventRegister,
+	 * and WFE below then does not sleep.
+	 * Not WFI, even when no deadline is pending: WFI would sleep with the work posted,
+	 * until some unrelated interrupt.
+	 */
+	if (not EventQueue::isEmpty()) {
+		EventQueue::dispatchAll();
+		return;
+	}
+
+	LongTime sleepStart = LongClock::nowTime();
+	if (isMeasuring) {
+		_timeAwake += sleepStart - lastWake;
+	}
+
+	/*
+	 * In debug, assert that nothing is left powered that should not be.
+	 * Impotent if NDEBUG.
+	 */
+	if (_isRadioWindowOpen) {
+		assertRadioPower();
+	}
+	else {
+		assertUltraLowPower();
+	}
+
+	MCUSleep::untilAnyEvent();
+
+	lastWake = LongClock::nowTime();
+	_timeAsleep += lastWake - sleepStart;
+	_countWakes++;
+	isMeasuring = true;
+}
+
+
+LongTime IdleScheduler::timeAsleep() { return _timeAsleep; }
+LongTime IdleScheduler::timeAwake() { return _timeAwake; }
+uint32_t IdleScheduler::countWakes() { return _countWakes; }
+
+void IdleScheduler::resetStatistics() {
+	_timeAsleep = 0;
+	_timeAwake = 0;
+	_countWakes = 0;
+	lastWake = LongClock::nowTime();
+	isMeasuring = true;
+}
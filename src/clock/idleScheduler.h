@@ -0,0 +1,63 @@
+#pragma once
+
+#include <inttypes.h>
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * Central idle loop: the one place the mcu sleeps between deadlines.
+ *
+ * Knows the earliest pending deadline across:
+ * - TaskTimer (its next RTCx_IRQ)
+ * - EventTimer (does not wake mcu, but reported)
+ * - an active radio window (declared by caller, since Radio does not know when a window ends)
+ *
+ * Tickless: no periodic tick, mcu sleeps until an interrupt of the next deadline (or any other interrupt.)
+ *
+ * Sleeps by WFE, never WFI:
+ * an interrupt since the last WFE (a deadline's, or an ISR posting work after the EventQueue was checked)
+ * has set the ARM EventRegister, and WFE then does not sleep (see TaskTimer.)
+ * A stale EventRegister costs one superfluous wake.
+ *
+ * Dispatches deferred work (EventQueue) before sleeping: does not sleep while work is posted.
+ *
+ * In debug, asserts the preconditions of powerAssertions before sleeping.
+ *
+ * Accumulates time asleep and awake, to measure duty cycle.
+ *
+ * Pure class, no instances.  Call from thread mode only.
+ */
+class IdleScheduler {
+public:
+	/*
+	 * Declare radio in use until end (e.g. receiving with a timeout.)
+	 * Changes which power assertions apply.
+	 */
+	static void openRadioWindow(LongTime end);
+	static void closeRadioWindow();
+	static bool isRadioWindowOpen();
+
+	/*
+	 * Earliest pending deadline not in the past.
+	 * Returns false if none.
+	 */
+	static bool nextDeadline(LongTime& deadline);
+
+	/*
+	 * Dispatch all posted work, then sleep once, until any interrupt (typically that of nextDeadline.)
+	 * Returns without sleeping if work was dispatched (caller's conditions may have changed.)
+	 * Caller loops, checking its own conditions after each return.
+	 */
+	static void sleepUntilNextDeadline();
+
+	/*
+	 * Duty cycle measurements, in ticks of LongClock.
+	 * Awake time accrues from the first call to sleepUntilNextDeadline() or resetStatistics().
+	 */
+	static LongTime timeAsleep();
+	static LongTime timeAwake();
+	static uint32_t countWakes();
+	static void resetStatistics();
+};
@@ -7,6 +7,10 @@
 
 // platform lib
 #include <drivers/clock/counter.h>
+#ifdef HF_TIMER_IS_REAL
+   #include <drivers/clock/hfTimer.h>
+#endif
+#include <drivers/oscillators/hfClock.h>
 #ifdef SOFTDEVICE_PRESENT
    #include <lowFreqClockCoordinated.h>	// from libNRFDrivers
 #else
@@ -39,6 +43,22 @@ LongTime priorNow = 0;	// for assertion
  */
 volatile uint32_t mostSignificantBits;
 
+/*
+ * Value of mostSignificantBits when longClockISR last finished servicing an overflow.
+ * While the two differ, the ISR has counted an overflow but not yet cleared its event.
+ * Lets a reader that preempts longClockISR know whether a pending overflow event is counted.
+ */
+volatile uint32_t servicedMostSignificantBits;
+
+
+bool _isPreciseMode = false;
+
+/*
+ * Largest fraction of a tick, in HF counts.
+ * A tick is 488 or 489 HF counts, so a fraction since this tick's capture is at most this.
+ */
+const uint32_t MaxPreciseFraction = LongClock::PreciseCountsPerTickNumerator / LongClock::PreciseCountsPerTickDenominator;
+
 
 } // namespace
 
@@ -46,8 +66,13 @@ volatile uint32_t mostSignificantBits;
 
 void LongClock::longClockISR() {
 	if ( Counter::isOverflowEvent() ) {
+		/*
+		 * Order matters to nowTimeISRSafe() in a preempting ISR:
+		 * count, clear event, then mark counted event serviced.
+		 */
 		mostSignificantBits++;
 		Counter::clearOverflowEventAndWaitUntilClear();
+		servicedMostSignificantBits = mostSignificantBits;
 		// assert interrupt still enabled
 		// assert counter is near zero (it rolled over just before the interrupt)
 		// assert event was definitely cleared (more than 4 clock cycles ago on Cortex M4.)
@@ -116,11 +141,28 @@ void LongClock::start() {
 
 void LongClock::resetToNearZero(){
 	mostSignificantBits = 0;
+	servicedMostSignificantBits = 0;
 }
 
 
 LongTime LongClock::nowTime() {
 
+	LongTime result = nowTimeISRSafe();
+
+#ifndef NDEBUG
+	/*
+	 * Monotonicity by design, but assert here
+	 */
+	assert(result >= priorNow);
+	priorNow = result;
+#endif
+
+	return result;
+}
+
+
+LongTime LongClock::nowTimeISRSafe() {
+
 	/*
 	 * Implementation: use Lamport's Rule.
 	 * To correctly catenate two 32-bit (sic) components of the 64-bit clock.
@@ -128,17 +170,39 @@ LongTime LongClock::nowTime() {
 	 * The components are volatile and incremented by separate threads.
 	 * ISR increments mostSignificantBits (separate thread, at any instant.)
 	 * leastSignificantBits are incremented by hw (separate thread.)
-	 * This routine is in a third separate thread (main thread.)
+	 * This routine is in a third separate thread (main thread, or an ISR.)
+	 *
+	 * Also read the overflow event, since the ISR might not have serviced it:
+	 * because the caller is an ISR of same or higher priority, or interrupts are masked.
 	 */
-	uint32_t firstMSBRead, secondMSBRead;
-	OSTime LSBRead;
+	uint32_t firstMSBRead, servicedMSBRead;
+	OSTime LSBReadBeforeEvent, LSBReadAfterEvent;
+	bool isOverflowPending;
 	do {
 		// Since mostSignficantBits is volatile, optimization does not optimize away the "consecutive" reads.
 		firstMSBRead = mostSignificantBits;
-		LSBRead = Counter::ticks();
-		secondMSBRead = mostSignificantBits;
+		servicedMSBRead = servicedMostSignificantBits;
+		LSBReadBeforeEvent = Counter::ticks();
+		isOverflowPending = Counter::isOverflowEvent();
+		LSBReadAfterEvent = Counter::ticks();
+	}
+	while ( (firstMSBRead != mostSignificantBits) or (servicedMSBRead != servicedMostSignificantBits) );
+
+	OSTime LSBRead;
+	if (isOverflowPending) {
+		/*
+		 * Counter overflowed before event was read, LSB read after is after the overflow.
+		 * When ISR has not counted it, count it here.
+		 */
+		LSBRead = LSBReadAfterEvent;
+		if (firstMSBRead == servicedMSBRead) firstMSBRead++;
+	}
+	else {
+		/*
+		 * Any overflow after event was read is not reflected in MSB, use LSB read before.
+		 */
+		LSBRead = LSBReadBeforeEvent;
 	}
-	while (firstMSBRead != secondMSBRead);
 
 	/*
 	 * Catenate MSB and LSB reads.  Portable?
@@ -151,14 +215,6 @@ LongTime LongClock::nowTime() {
 	 */
 	result = result | LSBRead;
 
-#ifndef NDEBUG
-	/*
-	 * Monotonicity by design, but assert here
-	 */
-	assert(result >= priorNow);
-	priorNow = result;
-#endif
-
 	return result;
 }
 
@@ -195,3 +251,99 @@ void LongClock::waitOneTick(){
 	}
 	while (nextTime == firstTime);
 }
+
+
+
+PreciseTime LongClock::preciseFromLongTime(LongTime time) {
+	/*
+	 * time * 15625 / 32, split to avoid overflowing 64 bits.
+	 * Floor, so each tick starts at least MaxPreciseFraction after the prior tick.
+	 */
+	PreciseTime whole = (time / PreciseCountsPerTickDenominator) * PreciseCountsPerTickNumerator;
+	PreciseTime part = ((time % PreciseCountsPerTickDenominator) * PreciseCountsPerTickNumerator) / PreciseCountsPerTickDenominator;
+	return whole + part;
+}
+
+
+void LongClock::startPreciseMode() {
+	assert(HfCrystalClock::isRunning());
+#ifdef HF_TIMER_IS_REAL
+	if (_isPreciseMode) return;
+
+	HfTimer::start();
+	HfTimer::connectCaptureOnEvent(Counter::getTickEventRegisterAddress());
+	Counter::enableTickEvent();
+	/*
+	 * Fraction is invalid until first capture.
+	 * Wait for it, so first precise time is not less than a prior coarse time.
+	 */
+	waitOneTick();
+	_isPreciseMode = true;
+#else
+	// Platform lacks HF timer: stay in coarse mode
+#endif
+}
+
+
+void LongClock::stopPreciseMode() {
+#ifdef HF_TIMER_IS_REAL
+	if (! _isPreciseMode) return;
+
+	_isPreciseMode = false;
+	Counter::disableTickEvent();
+	HfTimer::disconnectCaptureOnEvent();
+	HfTimer::stop();
+	/*
+	 * A precise time returned in this tick may be greater than the coarse time of this tick.
+	 * Let the tick pass so subsequent coarse times are greater.
+	 */
+	waitOneTick();
+#endif
+}
+
+
+bool LongClock::isPreciseMode() { return _isPreciseMode; }
+
+
+PreciseTime LongClock::nowTimePrecise() {
+	if ( not _isPreciseMode ) {
+		return preciseFromLongTime(nowTimeISRSafe());
+	}
+
+#ifdef HF_TIMER_IS_REAL
+	/*
+	 * HFXO stopped but thread mode has not yet called stopPreciseMode().
+	 * Fall back to RTC resolution without changing mode (this may be called from an ISR.)
+	 * Return the last precise time of the tick, not its first,
+	 * so the result is not less than a precise time returned earlier in the same tick.
+	 * (HFXO takes many ticks to restart, so no precise time follows in this tick.)
+	 */
+	if ( not HfCrystalClock::isRunning() ) {
+		return preciseFromLongTime(nowTimeISRSafe()) + MaxPreciseFraction;
+	}
+
+	/*
+	 * Lamport's Rule again: the fraction is valid only for the tick read before and after it.
+	 */
+	LongTime tickRead;
+	uint32_t fraction;
+	do {
+		tickRead = nowTimeISRSafe();
+		fraction = HfTimer::captureNow() - HfTimer::lastEventCapture();	// Unsigned, modulo math
+	}
+	while (tickRead != nowTimeISRSafe());
+
+	/*
+	 * Fraction larger than any tick: the capture is stale, from the prior tick
+	 * (the tick event has not yet propagated through PPI.)
+	 * This tick has just begun: the fraction is zero.
+	 * Not clamped to the end of the tick, which would exceed the next, fresh result.
+	 */
+	if (fraction > MaxPreciseFraction) fraction = 0;
+
+	return preciseFromLongTime(tickRead) + fraction;
+#else
+	// Not reached: never precise mode
+	return preciseFromLongTime(nowTimeISRSafe());
+#endif
+}
@@ -75,6 +75,14 @@
  * LongClock yields type LongTime (see embeddedMath).  Only 56 bits are valid.
  */
 
+/*
+ * Time in units of the HF timer, 1/16 uSec.
+ * PreciseCountsPerTick (488.28125) per tick of LongTime.
+ *
+ * Same epoch as LongTime: preciseFromLongTime(nowTime()) <= nowTimePrecise()
+ */
+typedef uint64_t PreciseTime;
+
 
 
 
@@ -115,9 +123,58 @@ public:
 	 */
 	static void resetToNearZero();
 
+	/*
+	 * nowTime() asserts monotonicity in debug builds, using state that is not reentrant.
+	 * Call from thread mode, or an ISR that no other caller of nowTime() preempts.
+	 */
 	static LongTime nowTime();
+
+	/*
+	 * Same as nowTime() but without the monotonicity assertion, and usable from any context:
+	 * - from ISR of higher priority than RTCx_IRQ
+	 * - with interrupts masked
+	 * Correct even when Counter has overflowed and longClockISR() has not yet serviced the overflow.
+	 *
+	 * Costs two more peripheral reads per loop than the former nowTime(), and no critical section
+	 * (by inspection, not measured.)
+	 * For timestamping packets in radioISR.
+	 */
+	static LongTime nowTimeISRSafe();
 	static OSTime osClockNowTime();	// LSB
 
 	static bool isOSClockRunning();
 	static void waitOneTick();
+
+
+	/*
+	 * High resolution mode.
+	 *
+	 * While HFXO is running (e.g. during radio activity) a HF timer (16Mhz)
+	 * extends the Counter with the fraction of the current tick.
+	 * The HF timer is captured on every Counter tick (via PPI),
+	 * and the fraction is the HF count since that capture.
+	 *
+	 * Costs current of HF timer and of Counter tick events: stop when HFXO is stopped.
+	 *
+	 * Requires platform support (nRF5x HfTimer, and Counter tick event), build with HF_TIMER_IS_REAL.
+	 * Without it, startPreciseMode() does nothing: never isPreciseMode().
+	 */
+	// 16Mhz / 32768hz = 15625/32
+	static const unsigned int PreciseCountsPerTickNumerator = 15625;
+	static const unsigned int PreciseCountsPerTickDenominator = 32;
+
+	/*
+	 * Requires HFXO running (HF timer would run from HFRC, less accurate.)
+	 */
+	static void startPreciseMode();
+	static void stopPreciseMode();
+	static bool isPreciseMode();
+
+	/*
+	 * Same monotonicity guarantees as nowTime().
+	 * When not isPreciseMode(), or HFXO not running, resolution is that of nowTime().
+	 * Never changes mode, usable from ISR: if HFXO stops, call stopPreciseMode() from thread mode.
+	 */
+	static PreciseTime nowTimePrecise();
+	static PreciseTime preciseFromLongTime(LongTime time);
 };
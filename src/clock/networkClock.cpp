@@ -0,0 +1,219 @@
+
+#include "networkClock.h"
+
+#include "longClock.h"
+
+#include <cassert>
+
+
+namespace {
+
+/*
+ * Ring of recent anchors.
+ * Offset is (network - local), which changes slowly, so differences are small.
+ */
+LongTime anchorLocal[NetworkClock::MaxAnchors];
+int64_t anchorOffset[NetworkClock::MaxAnchors];
+unsigned int anchorCount = 0;
+unsigned int newestIndex = 0;
+
+/*
+ * Model, referenced to the newest anchor.
+ */
+LongTime referenceLocal = 0;
+int64_t referenceOffset = 0;
+int64_t rate = 0;
+
+
+/*
+ * (difference * rate) in ticks.
+ * Signed shift is arithmetic (gcc.)
+ */
+int64_t scaleByRate(int64_t difference, int64_t aRate) {
+	return (difference * aRate) >> NetworkClock::RateFractionBits;
+}
+
+/*
+ * Count of bits needed for magnitude of value.
+ */
+unsigned int bitWidth(uint64_t value) {
+	unsigned int result = 0;
+	while (value != 0) {
+		value >>= 1;
+		result++;
+	}
+	return result;
+}
+
+
+/*
+ * Least squares fit of offset against local time, over anchors in the ring.
+ *
+ * Fixed point.  Local times are taken relative to their mean, and scaled down
+ * so that products fit in 64 bits, for anchors spanning up to many hours.
+ */
+void fit(int64_t& fitRate, int64_t& fitOffset) {
+	assert(anchorCount > 0);
+
+	LongTime newestLocal = anchorLocal[newestIndex];
+	int64_t newestOffset = anchorOffset[newestIndex];
+
+	if (anchorCount == 1) {
+		fitRate = 0;
+		fitOffset = newestOffset;
+		return;
+	}
+
+	// Means, relative to newest
+	int64_t sumX = 0;
+	int64_t sumY = 0;
+	for (unsigned int i = 0; i < anchorCount; i++) {
+		sumX += (int64_t) (anchorLocal[i] - newestLocal);
+		sumY += anchorOffset[i] - newestOffset;
+	}
+	int64_t meanX = sumX / (int64_t) anchorCount;
+	int64_t meanY = sumY / (int64_t) anchorCount;
+
+	// Scale so that largest deviation of x from mean fits in 16 bits
+	uint64_t maxDeviation = 0;
+	for (unsigned int i = 0; i < anchorCount; i++) {
+		int64_t deviation = (int64_t) (anchorLocal[i] - newestLocal) - meanX;
+		uint64_t magnitude = (deviation < 0) ? -deviation : deviation;
+		if (magnitude > maxDeviation) maxDeviation = magnitude;
+	}
+	unsigned int shift = (bitWidth(maxDeviation) > 16) ? bitWidth(maxDeviation) - 16 : 0;
+	assert(shift <= NetworkClock::RateFractionBits);
+
+	int64_t sumXX = 0;
+	int64_t sumXY = 0;
+	for (unsigned int i = 0; i < anchorCount; i++) {
+		int64_t dx = ((int64_t) (anchorLocal[i] - newestLocal) - meanX) >> shift;
+		int64_t dy = (anchorOffset[i] - newestOffset) - meanY;
+		sumXX += dx * dx;
+		sumXY += dx * dy;
+	}
+
+	if (sumXX == 0) {
+		// All anchors at same local time: no information about rate
+		fitRate = 0;
+	}
+	else {
+		fitRate = (sumXY * ((int64_t) 1 << (NetworkClock::RateFractionBits - shift))) / sumXX;
+	}
+
+	// Fitted line passes through means.  Evaluate at newest (x = 0)
+	fitOffset = newestOffset + meanY - scaleByRate(meanX, fitRate);
+}
+
+
+int64_t maxRate() {
+	return ((int64_t) NetworkClock::MaxRatePPM << NetworkClock::RateFractionBits) / 1000000;
+}
+
+
+/*
+ * Jitter of an anchor's offset, in ticks (timestamp resolution, interrupt latency.)
+ */
+const int64_t StepTolerance = 8;
+
+/*
+ * Is the step in offset from the newest anchor within MaxRatePPM over their span?
+ *
+ * Checked before fitting: it also bounds every offset difference in the ring
+ * (to MaxRatePPM of the ring's span, plus StepTolerance per anchor)
+ * so that the products in fit() do not overflow 64 bits.
+ */
+bool isPlausibleStep(LongTime localTime, int64_t offset) {
+	if (anchorCount == 0) return true;
+
+	int64_t span = (int64_t) (localTime - anchorLocal[newestIndex]);
+	int64_t step = offset - anchorOffset[newestIndex];
+	int64_t magnitude = (step < 0) ? -step : step;
+	return magnitude <= (span * NetworkClock::MaxRatePPM) / 1000000 + StepTolerance;
+}
+
+}	// namespace
+
+
+
+void NetworkClock::reset() {
+	anchorCount = 0;
+	newestIndex = 0;
+	referenceLocal = 0;
+	referenceOffset = 0;
+	rate = 0;
+}
+
+
+bool NetworkClock::addAnchor(LongTime localTime, LongTime networkTime) {
+	// Require anchors in order
+	assert((anchorCount == 0) or (localTime >= anchorLocal[newestIndex]));
+
+	int64_t offset = (int64_t) (networkTime - localTime);	// Unsigned, modulo math, then signed
+	if (not isPlausibleStep(localTime, offset)) {
+		// Outlier, e.g. a missed overflow: model unchanged
+		return false;
+	}
+
+	// Save state overwritten, in case anchor rejected
+	unsigned int priorCount = anchorCount;
+	unsigned int priorNewest = newestIndex;
+	unsigned int index = (anchorCount == 0) ? 0 : (newestIndex + 1) % MaxAnchors;
+	LongTime priorLocal = anchorLocal[index];
+	int64_t priorOffset = anchorOffset[index];
+
+	anchorLocal[index] = localTime;
+	anchorOffset[index] = offset;
+	newestIndex = index;
+	if (anchorCount < MaxAnchors) anchorCount++;
+
+	int64_t fitRate;
+	int64_t fitOffset;
+	fit(fitRate, fitOffset);
+
+	if ((fitRate > maxRate()) or (fitRate < -maxRate())) {
+		// Outlier of slope, though plausible step: restore
+		anchorLocal[index] = priorLocal;
+		anchorOffset[index] = priorOffset;
+		newestIndex = priorNewest;
+		anchorCount = priorCount;
+		return false;
+	}
+
+	referenceLocal = localTime;
+	referenceOffset = fitOffset;
+	rate = fitRate;
+	return true;
+}
+
+
+unsigned int NetworkClock::countAnchors() { return anchorCount; }
+
+
+LongTime NetworkClock::networkNowTime() {
+	return toNetworkTime(LongClock::nowTime());
+}
+
+
+LongTime NetworkClock::toNetworkTime(LongTime localTime) {
+	int64_t sinceReference = (int64_t) (localTime - referenceLocal);
+	return localTime + referenceOffset + scaleByRate(sinceReference, rate);
+}
+
+
+/*
+ * Inverse of toNetworkTime.
+ * One iteration suffices: error is on the order of rate squared.
+ */
+LongTime NetworkClock::toLocalTime(LongTime networkTime) {
+	LongTime estimate = networkTime - referenceOffset;
+	int64_t sinceReference = (int64_t) (estimate - referenceLocal);
+	return networkTime - referenceOffset - scaleByRate(sinceReference, rate);
+}
+
+
+int64_t NetworkClock::rateCorrection() { return rate; }
+
+int32_t NetworkClock::rateCorrectionPPM() {
+	return (int32_t) ((rate * 1000000) >> RateFractionBits);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <inttypes.h>
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * View of LongClock corrected to a network time (e.g. the clock of a sync master.)
+ *
+ * Every unit's LongClock drifts at its crystal's error (say 20ppm.)
+ * This estimates, from recent sync observations (anchors), a model:
+ *    network = local + offset + rate * (local - reference)
+ * by linear regression of (network - local) against local.
+ *
+ * Fixed point: rate is in units of 2^-RateFractionBits ticks per tick.
+ *
+ * Uses LongClock static methods.  LongClock instance must be started first.
+ *
+ * Pure class, no instances.  Not thread safe: add anchors and convert from the same context.
+ */
+class NetworkClock {
+public:
+	// Count of recent anchors in the regression.  Oldest is replaced.
+	static const unsigned int MaxAnchors = 8;
+
+	static const unsigned int RateFractionBits = 32;
+
+	/*
+	 * Anchors implying larger rate are outliers (e.g. a missed overflow, a foreign master)
+	 * and are rejected, leaving the model unchanged.
+	 * Both the step from the newest anchor, and the fitted rate, are checked.
+	 */
+	static const int32_t MaxRatePPM = 500;
+
+	/*
+	 * Forget all anchors, e.g. when sync master changes.
+	 * After reset, network time is local time.
+	 */
+	static void reset();
+
+	/*
+	 * Record that at localTime (on this LongClock) the network time was networkTime.
+	 * Typically localTime is the timeOfArrival of a sync message, and networkTime is carried in it.
+	 * Anchors must be added in order of localTime.
+	 *
+	 * Returns false if anchor was rejected as outlier.
+	 */
+	static bool addAnchor(LongTime localTime, LongTime networkTime);
+
+	static unsigned int countAnchors();
+
+	static LongTime networkNowTime();
+	static LongTime toNetworkTime(LongTime localTime);
+	static LongTime toLocalTime(LongTime networkTime);
+
+	/*
+	 * Estimated rate of network clock relative to this clock, less one.
+	 * Positive means this clock is slow.
+	 */
+	static int64_t rateCorrection();	// units 2^-RateFractionBits
+	static int32_t rateCorrectionPPM();
+};
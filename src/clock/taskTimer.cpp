@@ -5,6 +5,8 @@
 
 #include "../services/logger.h"
 #include "longClock.h"
+#include "timerQueue.h"
+#include "../services/eventQueue.h"
 
 // platform lib nRF5x
 #include <drivers/clock/compareRegister.h>
@@ -17,20 +19,69 @@
 #include <cassert>
 
 
-// TODO eliminate wrapper
+/*
+ * Implemented using one CompareRegister of RTC (index 0)
+ * shared by all scheduled Tasks: it holds the earliest deadline in TimerQueue.
+ */
+
+#define TASK_TIMER_INDEX 0
+
 
 namespace {
+
+/*
+ * Farthest a CompareRegister is set ahead of the Counter.
+ * Half the Counter range, so a compare value is never ambiguous with one already passed.
+ */
+const LongTime MaxCompareDistance = (MaxTimeout + 1) / 2;
+
+// Depth of nested critical sections
+unsigned int criticalDepth = 0;
+
+
+// Statistics of coalescing
+uint32_t _wakeupsSaved = 0;
+
 /*
- * Routine to call in ISR context (i.e. a Task)
+ * Time CompareRegister was last armed for: earliestLatestTime() when armed.
+ * A Task whose deadline precedes it was delayed (within its slack) to share that wakeup.
  */
-Task aTask = nullptr;
+LongTime _armedTime = 0;
+
+bool _isTasksDeferred = false;
+
 
 /*
- * TaskTimer can expire without underlying compare register events.
+ * Is deadline so near that CompareRegister might not generate an event?
+ * Such a deadline is considered expired already.
  */
-bool _isExpired = false;
+bool isDue(LongTime deadline) {
+	return deadline <= LongClock::nowTimeISRSafe() + LongClock::MinTimeout;
+}
+
 
-bool _isInUse = false;
+/*
+ * Requeue a periodic task that just expired, at its next deadline.
+ * Next deadline derived from prior deadline, not from now.
+ */
+void rearmPeriodic(ScheduledTask scheduled) {
+	scheduled.deadline += scheduled.period;
+	while (isDue(scheduled.deadline)) {
+		/*
+		 * Whole period already past (or too near for CompareRegister):
+		 * skip it rather than call task twice in a row.
+		 * Same test as handleExpirations, else a deadline within MinTimeout of now
+		 * is popped again in the same loop.
+		 */
+		scheduled.deadline += scheduled.period;
+		scheduled.missedPeriods++;
+	}
+	// Entry of the expired task was just freed, so cannot be full
+	bool isInserted = TimerQueue::insert(scheduled);
+	assert(isInserted);
+	(void) isInserted;
+	// Caller arms CompareRegister
+}
 
 }	// namespace
 
@@ -39,69 +90,110 @@ bool _isInUse = false;
 
 
 
+/*
+ * Only masks the one IRQ, other interrupts are not delayed.
+ * Count depth, so only the outermost exit unmasks.
+ * Depth is not raced: only thread mode and RTCx_IRQ (which is masked while depth > 0) enter.
+ */
+void TaskTimer::enterCriticalSection() {
+	NvicRaw::disableLFTimerIRQ();
+	criticalDepth++;
+}
+
+void TaskTimer::exitCriticalSection() {
+	assert(criticalDepth > 0);
+	criticalDepth--;
+	if (criticalDepth == 0) NvicRaw::enableLFTimerIRQ();
+}
+
+
 void TaskTimer::timerISR() {
 
 	/*
 	 * Called from RTCx_IRQ.
 	 * That may be called for counter overflow.
-	 * This should only be called when interrupt was pended or CompareRegister matched.
+	 * This may be called when interrupt was pended, CompareRegister matched, or neither.
 	 */
 
 	/*
 	 * Source events are "compare register matched counter"
-	 * First just determine which Timers are expired because their CompareRegister fired.
-	 * (They may also be expired because their duration was too short, without a CompareRegister event.)
+	 * (Tasks may also be expired because their duration was too short, without a CompareRegister event.)
 	 */
-	if ( compareRegisters[0].isEvent() ) {
-		compareRegisters[0].disableInterruptAndClearEvent();	//  early
-		_isExpired = true;
+	if ( compareRegisters[TASK_TIMER_INDEX].isEvent() ) {
+		compareRegisters[TASK_TIMER_INDEX].disableInterruptAndClearEvent();	//  early
 	}
 
 	/*
-	 * Second handle all expired Timers.
-	 * Some may have expired without their CompareRegister firing (for short timeout, via an interrupt pended i.e. forced.)
+	 * Handle all expired Tasks, whatever the source of the interrupt.
+	 * Some may have expired without the CompareRegister firing (for short timeout, via an interrupt pended i.e. forced.)
 	 */
-	if (_isExpired) {
-		handleExpiration();
-	}
+	handleExpirations();
 }
 
 
 /*
- * Called from RTCx_IRQHandler and timerISR, in ISR context (interrupts at same priority prevented.)
+ * Called from timerISR, in ISR context (interrupts at same priority prevented.)
  * When the underlying CompareRegister has matched, it has already been interrupt disabled and event cleared.
  */
-void TaskTimer::handleExpiration() {
+void TaskTimer::handleExpirations() {
 
 	/*
-	 * Mark not in use, so called task can reuse timer.
+	 * Expired Tasks are at the head of the queue, in order of deadline.
+	 * Pop before calling, so called task can reschedule itself.
+	 *
+	 * When coalescing, this wakeup is late for some deadlines (within their slack.)
+	 * Each distinct deadline earlier than the armed time would have been its own wakeup.
+	 * Deadlines not earlier merely expired together (e.g. from interrupt latency) and are not counted.
+	 * This wakeup replaces one of the delayed ones, unless some Task was not delayed.
 	 */
-	_isInUse = false;
+	unsigned int delayedDeadlines = 0;
+	bool isAnyNotDelayed = false;
+	LongTime priorDeadline = 0;
+	while ( (not TimerQueue::isEmpty()) and isDue(TimerQueue::earliestDeadline()) ) {
+		ScheduledTask expired = TimerQueue::popEarliest();
+
+		if (expired.deadline >= _armedTime) {
+			isAnyNotDelayed = true;
+		}
+		else if ((delayedDeadlines == 0) or (expired.deadline != priorDeadline)) {
+			delayedDeadlines++;
+		}
+		priorDeadline = expired.deadline;
+
+		if (expired.period != 0) {
+			rearmPeriodic(expired);
+		}
+
+		if (_isTasksDeferred) {
+			// Called later in thread mode.  If EventQueue is full, task is lost (and counted.)
+			(void) EventQueue::post(expired.task, EventPriority::Normal);
+		}
+		else {
+			/*
+			 * Callback, still in interrupt context.
+			 * Callback may generate more interrupts, and schedule more Tasks.
+			 */
+			expired.task();
+		}
+	}
 
-	/*
-	 * Callback, still in interrupt context.
-	 * Callback may generate more interrupts.
-	 */
-	aTask();
+	if (delayedDeadlines > 0) {
+		_wakeupsSaved += isAnyNotDelayed ? delayedDeadlines : delayedDeadlines - 1;
+	}
 
 	/*
-	 * Assert Task completed.
-	 * Task may be reusing TaskTimer already.
+	 * CompareRegister for the next earliest, if any.
 	 *
 	 * Compare registers will still generate match events if counter cycles (4 minutes)
 	 * and such events will wake any WEV.
-	 * But unless the Task is using TaskTimer again,
+	 * But unless a Task is scheduled,
 	 * no interrupts are enabled for match events.
 	 */
+	armCompareRegister();
 }
 
 
-void TaskTimer::schedule(Task task, OSTime duration) {
-	// Not legal to start Timer already started and not timed out or canceled.
-	// Not legal to start twice, catch before destroying old task.
-	assert(not _isInUse);
-
-	aTask = task;
+bool TaskTimer::schedule(Task task, OSTime duration, OSTime slack) {
 
 	// Usually name of task is logged just ahead of this
 	RTTLogger::log(":"); RTTLogger::log(duration);
@@ -120,71 +212,176 @@ void TaskTimer::schedule(Task task, OSTime duration) {
 	 * (the more time we spend here, the later the real timeout will occur
 	 * after the time for which the timeout was calculated.
 	 */
-	//assert(duration < MaxTimeout);
+	assert(duration <= MaxTimeout);
 	// assert RTCx_IRQ enabled (enabled earlier for Counter, and stays enabled.
 
-	_isExpired = false;
-	_isInUse = true;
+	return scheduleAt(task, LongClock::nowTimeISRSafe() + duration, slack);
+}
+
+
+bool TaskTimer::scheduleAt(Task task, LongTime deadline, OSTime slack) {
+
+	enterCriticalSection();
+
+	// Not legal to start Task already scheduled and not timed out or canceled.
+	// Catch before destroying old deadline.
+	assert(not TimerQueue::contains(task));
+
+	bool result = TimerQueue::insert({task, deadline, 0, slack, 0});
+	if (result) {
+		/*
+		 * Arm even if not the earliest deadline:
+		 * with slack, a later deadline can be the earliest time some Task must be called.
+		 */
+		armCompareRegister();
+	}
+
+	exitCriticalSection();
+	// Task may already be expired, interrupt generated, and task called
+	return result;
+}
+
 
-	configureCompareRegisterForTimer(0, duration);
-	// Timer may already be expired, interrupt generated, and callback called
+bool TaskTimer::schedulePeriodic(Task task, OSTime period, OSTime slack) {
+	return schedulePeriodicAt(task, LongClock::nowTimeISRSafe() + period, period, slack);
+}
+
+
+bool TaskTimer::schedulePeriodicAt(Task task, LongTime firstDeadline, OSTime period, OSTime slack) {
+	// Else rearmed deadline is always due, and timerISR never returns
+	assert(period > LongClock::MinTimeout);
+	assert(period <= MaxTimeout);
+
+	enterCriticalSection();
+
+	assert(not TimerQueue::contains(task));
+
+	bool result = TimerQueue::insert({task, firstDeadline, period, slack, 0});
+	if (result) {
+		armCompareRegister();
+	}
+
+	exitCriticalSection();
+	return result;
+}
+
+
+uint32_t TaskTimer::missedPeriods(Task task) {
+	enterCriticalSection();
+	const ScheduledTask* scheduled = TimerQueue::find(task);
+	uint32_t result = (scheduled != nullptr) ? scheduled->missedPeriods : 0;
+	exitCriticalSection();
+	return result;
+}
+
+
+void TaskTimer::cancel(Task task) {
+	enterCriticalSection();
+	if (TimerQueue::contains(task)) {
+		TimerQueue::remove(task);
+		armCompareRegister();
+	}
+	exitCriticalSection();
+}
+
+
+bool TaskTimer::isScheduled(Task task) {
+	enterCriticalSection();
+	bool result = TimerQueue::contains(task);
+	exitCriticalSection();
+	return result;
+}
+
+
+uint32_t TaskTimer::wakeupsSaved() { return _wakeupsSaved; }
+
+void TaskTimer::setTasksDeferred(bool isDeferred) { _isTasksDeferred = isDeferred; }
+
+bool TaskTimer::isTasksDeferred() { return _isTasksDeferred; }
+
+
+bool TaskTimer::nextWakeTime(LongTime& wakeTime) {
+	enterCriticalSection();
+	bool result = not TimerQueue::isEmpty();
+	if (result) {
+		wakeTime = TimerQueue::earliestLatestTime();
+	}
+	exitCriticalSection();
+	return result;
 }
 
 
 
 
 /*
- * A Timer is built upon a CompareRegister.
+ * A Task deadline is kept by a CompareRegister.
  * Since a CompareRegister has limitations, do more here to accommodate limitations.
- * This is a concern of the Timer, not of the CompareRegister.
+ * This is a concern of the TaskTimer, not of the CompareRegister.
+ *
+ * Called with RTCx_IRQ masked or from within it.
  *
  * Should be no references to platform here.
  */
-void TaskTimer::configureCompareRegisterForTimer(TaskTimerIndex index, OSTime timeout){
-	// require event disabled?
+void TaskTimer::armCompareRegister(){
 
-	OSTime beforeCounter = LongClock::osClockNowTime();
 	/*
-	 * Interrupts are not disabled.
-	 * The counter may continue running while servicing interrupts.
-	 * Thus currentCount can get stale, and we must accommodate.
+	 * Clear any stale event (from counter cycling past an old value)
+	 * so enabling interrupt below does not generate a superfluous interrupt.
+	 */
+	compareRegisters[TASK_TIMER_INDEX].disableInterruptAndClearEvent();
+
+	if (TimerQueue::isEmpty()) {
+		return;
+	}
+
+	/*
+	 * Not the earliest deadline, but the latest time within every Task's slack.
 	 */
+	LongTime deadline = TimerQueue::earliestLatestTime();
+	_armedTime = deadline;
+
+	/*
+	 * A deadline beyond the range of the Counter is reached by a chain of intermediate compares.
+	 * At each intermediate compare, timerISR finds nothing due and arms the next link.
+	 */
+	LongTime compareTime = deadline;
+	LongTime now = LongClock::nowTimeISRSafe();
+	if ( (deadline > now) and (deadline - now > MaxCompareDistance) ) {
+		compareTime = now + MaxCompareDistance;
+	}
+
 	/*
 	 * RTC is 24-bit timer.
-	 * Value is computed in 32-bit math.
 	 * We don't need need modulo 24-bit math (mask with 0xFFFFFF)
 	 * because the HW of the comparator only reads the lower 24-bits (effectively masks with 0xFFFFFF).
 	 * But the values set and get might have ones in upper 8-bits.
 	 * Can only assert(nrf_rtc_cc_get() == newCompareValue);
 	 */
-	unsigned int newCounterValue = beforeCounter + timeout;
-
 	/*
-	 * Setting timeout and enabling interrupt must be close together,
+	 * Setting compare value and enabling interrupt must be close together,
 	 * else counter exceeds compare already, and no interrupt till much later after counter rolls over.
 	 */
-	compareRegisters[index].set(newCounterValue);
-
-	OSTime afterCounter = LongClock::osClockNowTime();
+	compareRegisters[TASK_TIMER_INDEX].set(static_cast<OSTime>(compareTime));
 
 	/*
-	 * If newCounterValue is not far in the future, CompareRegister will not generate event (or interrupt)
+	 * Interrupts are not disabled.
+	 * The counter may continue running while servicing interrupts.
+	 * Thus check deadline against counter AFTER setting.
+	 *
+	 * If deadline is not far in the future, CompareRegister will not generate event (or interrupt)
 	 * (or it will be one Counter full late) because of HW limitations.
 	 *
 	 * Compare to NRF_SDK app_timer.c
 	 */
-	if (((afterCounter - beforeCounter) + LongClock::MinTimeout ) > timeout) {
+	if ( isDue(compareTime) ) {
 		/*
 		 * CompareRegister might not generate event.
 		 * It might (and then this will be repeated/superfluous, but not undone.)
-		 */
-		// Mark timer expired already (the small duration is elapsed already.)
-		_isExpired = true;
-		/*
+		 *
 		 * Pend interrupt.
 		 * The RTCx_IRQ is always enabled, this might generate immediate jump to ISR.
 		 * When caller is a task, in ISR context, the interrupt will process when this task completes.
-		 * ISR will see the expired timer, and handle it, even though no event from compare register.
+		 * ISR will see the due deadline, and handle it, even though no event from compare register.
 		 */
 
 		// assert SD disabled, so safe to use raw NVIC
@@ -198,7 +395,7 @@ void TaskTimer::configureCompareRegisterForTimer(TaskTimerIndex index, OSTime ti
 	 * When we enableInterrupt, CompareRegister will generate interrupt
 	 * when compare match event happens, or if already set.
 	 */
-	compareRegisters[index].enableInterrupt();
+	compareRegisters[TASK_TIMER_INDEX].enableInterrupt();
 
 
 	/*
@@ -216,5 +413,3 @@ void TaskTimer::configureCompareRegisterForTimer(TaskTimerIndex index, OSTime ti
 	 * The interrupt typically COULD come in as little as 3 ticks, or 3*30 = 90uSec, which allows about 1440 instructions.
 	 */
 }
-
-
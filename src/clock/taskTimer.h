@@ -1,8 +1,10 @@
-
 #pragma once
 
 #include "../platformTypes.h"   // OSTime
 
+// embeddedMath
+#include <timeTypes.h>    // LongTime
+
 typedef void (*Task)(void);
 
 typedef unsigned int TaskTimerIndex;
@@ -11,18 +13,108 @@ typedef unsigned int TaskTimerIndex;
 
 
 /*
- * Schedules Task for future.
+ * Schedules Tasks for future.
  * Uses Counter/CompareRegister.
  *
+ * Many Tasks can be scheduled at once (up to TimerQueue::Capacity.)
+ * They share one CompareRegister, which holds the earliest deadline.
+ * Tasks are called in order of deadline, in ISR context.
+ *
+ * A Task is its own identity: not legal to schedule a Task already scheduled.
+ *
+ * Schedule methods return false, and schedule nothing, if Capacity Tasks are already scheduled.
+ *
+ * Coalescing:
+ * A Task may be given slack: it may be called up to slack after its deadline.
+ * The CompareRegister is set to the latest time that satisfies every Task's slack,
+ * and every Task whose deadline is past is called on the same wakeup.
+ * Slack of zero (the default) is an exact deadline.
+ *
+ * Call from thread mode, or from a Task (ISR context of RTCx_IRQ.)
+ * Not legal to call from an ISR of higher priority than RTCx_IRQ.
+ *
  * Derives from old implementation Timer (for design using Sleepers)
  */
 class TaskTimer {
 private:
-	static void configureCompareRegisterForTimer(TaskTimerIndex index, OSTime timeout);
-	static void handleExpiration();
+	static void armCompareRegister();
+	static void handleExpirations();
 
 public:
-	static void schedule(Task task, OSTime duration);
+	/*
+	 * Schedule task duration from now.
+	 * Deadline is computed at time of call: any delay in calling accumulates.
+	 */
+	static bool schedule(Task task, OSTime duration, OSTime slack = 0);
+
+	/*
+	 * Schedule task at an absolute time on the LongClock.
+	 *
+	 * deadline may be:
+	 * - already past: task is called soon (interrupt is pended)
+	 * - farther in the future than MaxTimeout: intermediate compares are chained
+	 *
+	 * Use for periodic schedules: deriving next deadline from the prior deadline does not accumulate error.
+	 */
+	static bool scheduleAt(Task task, LongTime deadline, OSTime slack = 0);
+
+	/*
+	 * Schedule task to be called every period, first at firstDeadline.
+	 *
+	 * Each next deadline is the prior deadline plus period (not now plus period)
+	 * so neither interrupt latency nor task duration accumulates.
+	 * Rearmed in timerISR before task is called: task must not reschedule itself, but may cancel itself.
+	 *
+	 * If a deadline has passed before rearm (interrupts blocked longer than a period)
+	 * that period is skipped and counted, see missedPeriods().
+	 *
+	 * Requires period > LongClock::MinTimeout.
+	 */
+	static bool schedulePeriodicAt(Task task, LongTime firstDeadline, OSTime period, OSTime slack = 0);
+	// First deadline one period from now
+	static bool schedulePeriodic(Task task, OSTime period, OSTime slack = 0);
+
+	/*
+	 * Count of periods skipped for a periodic task.
+	 * Zero if task is not scheduled.
+	 */
+	static uint32_t missedPeriods(Task task);
+
+	/*
+	 * Count of wakeups avoided by coalescing:
+	 * for each RTCx_IRQ, count of distinct deadlines that used their slack to share it,
+	 * less one if no Task was called at (or after) its own deadline.
+	 * Tasks whose deadlines merely expired together (without slack) are not counted.
+	 */
+	static uint32_t wakeupsSaved();
+
+	/*
+	 * When deferred, expired Tasks are posted to EventQueue (priority Normal)
+	 * and called later in thread mode, instead of called in timerISR.
+	 * Keeps timerISR short, so it does not delay other interrupts.
+	 * Default not deferred.
+	 */
+	static void setTasksDeferred(bool isDeferred);
+	static bool isTasksDeferred();
+
+	/*
+	 * When the RTCx_IRQ for Tasks will next occur.
+	 * Returns false if no Task is scheduled.
+	 */
+	static bool nextWakeTime(LongTime& wakeTime);
+
+	/*
+	 * Does nothing if task is not scheduled.
+	 */
+	static void cancel(Task task);
+	static bool isScheduled(Task task);
+
+	/*
+	 * Guard against the RTCx_IRQ, in which Tasks are called and which modifies scheduled Tasks.
+	 * Nestable: for callers whose own critical section calls TaskTimer.
+	 */
+	static void enterCriticalSection();
+	static void exitCriticalSection();
 
 	/*
 	 * Called from the IRQ handler.
@@ -0,0 +1,159 @@
+
+#include "timerQueue.h"
+
+#include <cassert>
+
+
+namespace {
+
+/*
+ * Index meaning "no entry", terminates lists.
+ */
+const uint8_t NoEntry = 0xFF;
+
+struct TimerEntry {
+	ScheduledTask scheduled;
+	uint8_t next;
+};
+
+TimerEntry entries[TimerQueue::Capacity];
+
+// Head of list sorted by deadline
+uint8_t earliest = NoEntry;
+
+/*
+ * Head of list of unused entries.
+ * Lazily initialized, since no init() is required of TaskTimer.
+ */
+uint8_t freeEntries = NoEntry;
+bool isFreeListInitialized = false;
+
+
+void initFreeListIfNeeded() {
+	if (isFreeListInitialized) return;
+
+	for (unsigned int i = 0; i < TimerQueue::Capacity - 1; i++) {
+		entries[i].next = i + 1;
+	}
+	entries[TimerQueue::Capacity - 1].next = NoEntry;
+	freeEntries = 0;
+	isFreeListInitialized = true;
+}
+
+/*
+ * Returns NoEntry if none free.
+ */
+uint8_t allocateEntry() {
+	initFreeListIfNeeded();
+	uint8_t result = freeEntries;
+	if (result != NoEntry) {
+		freeEntries = entries[result].next;
+	}
+	return result;
+}
+
+void freeEntry(uint8_t index) {
+	entries[index].scheduled.task = nullptr;
+	entries[index].next = freeEntries;
+	freeEntries = index;
+}
+
+}	// namespace
+
+
+
+bool TimerQueue::isEmpty() { return earliest == NoEntry; }
+
+bool TimerQueue::isFull() {
+	initFreeListIfNeeded();
+	return freeEntries == NoEntry;
+}
+
+bool TimerQueue::contains(Task task) { return find(task) != nullptr; }
+
+const ScheduledTask* TimerQueue::find(Task task) {
+	for (uint8_t index = earliest; index != NoEntry; index = entries[index].next) {
+		if (entries[index].scheduled.task == task) return &entries[index].scheduled;
+	}
+	return nullptr;
+}
+
+
+bool TimerQueue::insert(const ScheduledTask& scheduledTask) {
+	assert(scheduledTask.task != nullptr);
+	assert(not contains(scheduledTask.task));
+
+	LongTime deadline = scheduledTask.deadline;
+	uint8_t newIndex = allocateEntry();
+	if (newIndex == NoEntry) return false;	// full
+
+	entries[newIndex].scheduled = scheduledTask;
+
+	/*
+	 * Find the entry to link after: the last whose deadline is not later than the new deadline.
+	 * Strictly later, so equal deadlines expire in order scheduled.
+	 */
+	if ((earliest == NoEntry) or (entries[earliest].scheduled.deadline > deadline)) {
+		entries[newIndex].next = earliest;
+		earliest = newIndex;
+		return true;
+	}
+
+	uint8_t prior = earliest;
+	while ((entries[prior].next != NoEntry) and (entries[entries[prior].next].scheduled.deadline <= deadline)) {
+		prior = entries[prior].next;
+	}
+	entries[newIndex].next = entries[prior].next;
+	entries[prior].next = newIndex;
+	return true;
+}
+
+
+void TimerQueue::remove(Task task) {
+	uint8_t prior = NoEntry;
+	for (uint8_t index = earliest; index != NoEntry; index = entries[index].next) {
+		if (entries[index].scheduled.task == task) {
+			if (prior == NoEntry) earliest = entries[index].next;
+			else entries[prior].next = entries[index].next;
+			freeEntry(index);
+			return;
+		}
+		prior = index;
+	}
+}
+
+
+LongTime TimerQueue::earliestDeadline() {
+	assert(not isEmpty());
+	return entries[earliest].scheduled.deadline;
+}
+
+
+ScheduledTask TimerQueue::popEarliest() {
+	assert(not isEmpty());
+
+	uint8_t index = earliest;
+	ScheduledTask result = entries[index].scheduled;
+	earliest = entries[index].next;
+	freeEntry(index);
+	return result;
+}
+
+
+LongTime TimerQueue::earliestLatestTime() {
+	assert(not isEmpty());
+
+	LongTime result = entries[earliest].scheduled.deadline + entries[earliest].scheduled.slack;
+
+	/*
+	 * Sorted by deadline, so stop when deadline alone is not earlier than result.
+	 * Usually only a few entries are visited.
+	 */
+	for (uint8_t index = entries[earliest].next;
+			(index != NoEntry) and (entries[index].scheduled.deadline < result);
+			index = entries[index].next) {
+		LongTime latest = entries[index].scheduled.deadline + entries[index].scheduled.slack;
+		if (latest < result) result = latest;
+	}
+	return result;
+}
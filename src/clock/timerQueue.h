@@ -0,0 +1,86 @@
+#pragma once
+
+#include "taskTimer.h"	// Task
+
+// embeddedMath
+#include <timeTypes.h>    // LongTime
+
+
+/*
+ * What TimerQueue holds for a scheduled Task.
+ */
+struct ScheduledTask {
+	Task task;
+	LongTime deadline;
+
+	// Zero means one-shot
+	OSTime period;
+
+	// Task may be called this much later than deadline, to share a wakeup with other tasks
+	OSTime slack;
+
+	// Count of periods skipped because their deadline passed before rearm
+	uint32_t missedPeriods;
+};
+
+
+/*
+ * Statically sized queue of pending Tasks, ordered by deadline.
+ *
+ * Owned by TaskTimer, which keeps only the earliest deadline in a CompareRegister.
+ *
+ * Implementation:
+ * - fixed pool of entries, no heap
+ * - entries are linked by index into a list sorted by ascending deadline
+ * - free entries are linked into a free list
+ *
+ * Cost:
+ * - taking an entry from the free list and popping the earliest are O(1)
+ * - insert walks the sorted list, bounded by Capacity (small)
+ * - equal deadlines are kept in order of insertion
+ *
+ * Not thread safe: caller (TaskTimer) guards against the RTCx_IRQ.
+ *
+ * Pure class, no instances.
+ */
+class TimerQueue {
+public:
+	/*
+	 * Count of Tasks that can be scheduled at the same time.
+	 */
+	static const unsigned int Capacity = 8;
+
+	static bool isEmpty();
+	static bool isFull();
+	static bool contains(Task task);
+
+	/*
+	 * Returns nullptr if not contains(task).
+	 * Result is valid until queue is next changed.
+	 */
+	static const ScheduledTask* find(Task task);
+
+	/*
+	 * Requires not contains(task).
+	 * Returns false (and does nothing) if isFull().
+	 */
+	static bool insert(const ScheduledTask& scheduledTask);
+
+	/*
+	 * Does nothing if not contains(task).
+	 */
+	static void remove(Task task);
+
+	/*
+	 * Require not isEmpty()
+	 */
+	static LongTime earliestDeadline();
+	static ScheduledTask popEarliest();
+
+	/*
+	 * Latest time that still calls every Task within its slack:
+	 * least over all Tasks of deadline + slack.
+	 * Require not isEmpty()
+	 */
+	static LongTime earliestLatestTime();
+};
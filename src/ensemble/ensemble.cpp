@@ -21,6 +21,8 @@
 
 #include "../radioUseCase/radioUseCase.h"
 
+#include "../clock/idleScheduler.h"
+
 
 namespace {
 
@@ -28,6 +30,36 @@ namespace {
 	RadioUseCase* activeUseCase = nullptr;
 
 	// !!! Some parameters of use case can be changed and apply immediately to ensemble.
+
+	// Radio was told to disable, but it may not be disabled yet
+	bool isStopReceivePending = false;
+
+	/*
+	 * Precede any radio operation.
+	 */
+	void completePendingStop() {
+		if (isStopReceivePending) {
+			Radio::completeStopReceive();
+			isStopReceivePending = false;
+		}
+	}
+
+	uint32_t reconfigurations = 0;
+
+	/*
+	 * Precede any radio operation, after completePendingStop().
+	 *
+	 * Configuration can be lost, e.g. when SoftDevice used radio (sequential multiprotocol.)
+	 * Signature comparison is cheap (a few register reads), reconfiguring only when needed.
+	 */
+	void ensureConfigured() {
+		if (Radio::isConfiguredForSleepSync()) return;
+
+		reconfigurations++;
+		Radio::configureForSleepSync();
+		// Use case parameters may also be lost
+		if (activeUseCase != nullptr) activeUseCase->applyToRadio();
+	}
 }
 
 
@@ -44,6 +76,9 @@ void Ensemble::setRadioUseCase(RadioUseCase* aRadioUseCase){
 	activeUseCase = aRadioUseCase;
 	assert(activeUseCase!=nullptr);
 
+	// Configuration requires radio disabled
+	completePendingStop();
+
 	/*
 	 * Configuration changes when use case changes.
 	 *
@@ -64,6 +99,8 @@ void Ensemble::setRadioUseCase(RadioUseCase* aRadioUseCase){
 // The only member that needs configuration is Radio
 bool Ensemble::isConfigured(){ return Radio::isConfiguredForSleepSync(); }
 
+uint32_t Ensemble::countReconfigurations() { return reconfigurations; }
+
 
 bool Ensemble::isLowPower() {
 #ifdef RADIO_POWER_IS_REAL
@@ -77,7 +114,10 @@ bool Ensemble::isLowPower() {
 /*
  * Methods simply to the Radio.
  */
-bool Ensemble::isRadioInUse() 			   { return Radio::isInUse(); }
+bool Ensemble::isRadioInUse() {
+	completePendingStop();
+	return Radio::isInUse();
+}
 BufferPointer Ensemble::getBufferAddress() { return Radio::getBufferAddress(); }
 bool Ensemble::isPacketCRCValid()          { return Radio::isPacketCRCValid(); }
 unsigned int Ensemble::getRSSI()          { return Radio::receivedSignalStrength(); }
@@ -139,6 +179,9 @@ void Ensemble::startup() {
 
 
 void Ensemble::shutdown() {
+	// Radio must be disabled before HFXO stops
+	completePendingStop();
+
 	HfCrystalClock::stop();
 
 #ifdef RADIO_POWER_IS_REAL
@@ -150,6 +193,9 @@ void Ensemble::shutdown() {
 
 	// disable because Vcc may be below what DCDCPowerSupply requires
 	DCDCPowerSupply::disable();
+
+	// Any radio window is over
+	IdleScheduler::closeRadioWindow();
 }
 
 
@@ -162,6 +208,8 @@ void Ensemble::startReceiving() {
 	// TODO should this be in caller?
 	// OLD syncSleeper.clearReasonForWake();
 
+	completePendingStop();
+	ensureConfigured();
 	assert(Radio::isPowerOn());
 	Radio::receiveStatic();
 	assert(Radio::isInUse());
@@ -179,6 +227,7 @@ void Ensemble::startReceiving() {
 
 
 void Ensemble::stopReceiving() {
+	completePendingStop();
 	if (Radio::isInUse()) {
 		Radio::stopReceive();
 	}
@@ -186,10 +235,28 @@ void Ensemble::stopReceiving() {
 }
 
 
+void Ensemble::stopReceivingAsync() {
+	completePendingStop();
+	if (Radio::isInUse()) {
+		Radio::beginStopReceive();
+		isStopReceivePending = true;
+	}
+}
+
+bool Ensemble::isStopPending() { return isStopReceivePending; }
+
+
 void Ensemble::transmitStaticSynchronously(){
+	// A prior per-packet power does not persist
+	transmitStaticSynchronously(RadioUseCase::defaultXmitPower());
+}
+
+
+void Ensemble::transmitStaticSynchronously(TransmitPowerdBm power){
+	completePendingStop();
+	ensureConfigured();
 	assert(Radio::isPowerOn());
-	assert(Radio::isConfiguredForSleepSync());
 
-	Radio::transmitStaticSynchronously();
+	Radio::transmitStaticSynchronously(power);
 }
 
@@ -41,6 +41,11 @@
  * 1) need to explicitly use RadioPowerAPI
  * 2) The HW radio automatically enters low-power standby without explicit control from above.
  * See RADIO_POWER_IS_REAL #ifdefs
+ *
+ * Optional platform support, not in every nRF5x library: its code is compiled out unless defined.
+ * Without it, that code is dead by intent.
+ * HF_TIMER_IS_REAL: precise mode of LongClock (nowTimePrecise() at 1/16 uSec.)  Else times are coarse.
+ * RSSI_TASK_IS_REAL: Radio::scanChannels() and quietestChannel().  Else not declared.
  */
 // XXX make ensemble own radio.  Currently, other code calls radio methods.
 
@@ -78,8 +83,20 @@ public:
 
 	static void stopReceiving();
 
-	// Blocks.  Lag before OTA.
+	/*
+	 * Non-blocking stopReceiving().
+	 * Ensemble completes the stop (waits for radio disabled) before its next operation that uses the radio.
+	 */
+	static void stopReceivingAsync();
+	static bool isStopPending();
+
+	/*
+	 * Blocks.  Lag before OTA.
+	 * At power of the active RadioUseCase, or at power given for this packet.
+	 * Device register is written only when power changes.
+	 */
 	static void transmitStaticSynchronously();
+	static void transmitStaticSynchronously(TransmitPowerdBm power);
 
 	/*
 	 * Illegal to call when ensemble is shutdown (power off.)
@@ -91,4 +108,11 @@ public:
 	static bool isLowPower();
 
 	static bool isConfigured();
+
+	/*
+	 * Before each radio operation (receive, transmit) configuration is checked,
+	 * and if lost (e.g. SoftDevice used the radio) the active RadioUseCase is re-applied.
+	 * Count of times that happened.
+	 */
+	static uint32_t countReconfigurations();
 };
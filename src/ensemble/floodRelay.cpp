@@ -0,0 +1,99 @@
+
+#include <cassert>
+
+#include "floodRelay.h"
+
+#include "../radio/radio.h"
+
+
+namespace {
+
+bool _isEnabled = false;
+uint8_t _typeOffset;
+uint8_t _typeValue;
+uint8_t _hopCountOffset;
+uint8_t _maxHopCount;
+PreciseTime _turnaround;
+MsgReceivedCallback _nextCallback = nullptr;
+
+uint32_t relayed = 0;
+uint32_t late = 0;
+
+
+void relayIfFlood() {
+	if (not Radio::isPacketCRCValid()) return;
+	if (not LongClock::isPreciseMode()) return;
+
+	BufferPointer buffer = Radio::getBufferAddress();
+	if (buffer[_typeOffset] != _typeValue) return;
+
+	uint8_t hopCount = buffer[_hopCountOffset];
+	if (hopCount >= _maxHopCount) return;
+
+	PreciseTime transmitTime = Radio::preciseTimeOfArrival() + _turnaround;
+	if (LongClock::nowTimePrecise() >= transmitTime) {
+		late++;
+		return;
+	}
+
+	buffer[_hopCountOffset] = hopCount + 1;
+
+	// Keep originator's timestamp: no stamper during relay
+	TransmitStamper stamper = Radio::transmitStamper();
+	Radio::setTransmitStamper(nullptr);
+
+	// Deterministic: spin to exact time, then rampup of fixed duration
+	while (LongClock::nowTimePrecise() < transmitTime) {}
+	Radio::transmitStaticSynchronouslyFromCallback();
+	relayed++;
+
+	Radio::setTransmitStamper(stamper);
+}
+
+
+// In radioISR
+void relayingCallback() {
+	relayIfFlood();
+
+	assert(_nextCallback != nullptr);
+	_nextCallback();
+}
+
+}	// namespace
+
+
+
+void FloodRelay::enable(uint8_t typeOffset, uint8_t typeValue,
+		uint8_t hopCountOffset, uint8_t maxHopCount,
+		PreciseTime turnaround, MsgReceivedCallback nextCallback) {
+	assert(typeOffset < Radio::FixedPayloadCount);
+	assert(hopCountOffset < Radio::FixedPayloadCount);
+	assert(typeOffset != hopCountOffset);
+	assert(nextCallback != nullptr);
+
+	_typeOffset = typeOffset;
+	_typeValue = typeValue;
+
+	_hopCountOffset = hopCountOffset;
+	_maxHopCount = maxHopCount;
+	_turnaround = turnaround;
+	_nextCallback = nextCallback;
+	relayed = 0;
+	late = 0;
+	Radio::setMsgReceivedCallback(relayingCallback);
+	_isEnabled = true;
+}
+
+
+void FloodRelay::disable() {
+	if (not _isEnabled) return;
+
+	Radio::setMsgReceivedCallback(_nextCallback);
+	_isEnabled = false;
+}
+
+
+bool FloodRelay::isEnabled() { return _isEnabled; }
+
+uint32_t FloodRelay::countRelayed() { return relayed; }
+uint32_t FloodRelay::countLate() { return late; }
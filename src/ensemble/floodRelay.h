@@ -0,0 +1,47 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "ensemble.h"	// MsgReceivedCallback
+#include "../clock/longClock.h"	// PreciseTime
+
+
+/*
+ * Flood relay (Glossy style.)
+ *
+ * On receiving a flood packet (valid CRC, message type matches, hop count below max)
+ * increment hop count in the radio buffer and retransmit it
+ * at a fixed turnaround after the packet's arrival.
+ * Other packets (e.g. sync) are passed to the next callback, not relayed.
+ * Since every relay uses the same turnaround, relays hearing the same packet
+ * transmit concurrently and interfere constructively.
+ *
+ * Relay is done in radioISR, before the next layer's callback
+ * (which then sees the packet with incremented hop count.)
+ * Relayed packet is not stamped (see Radio::setTransmitStamper()): it keeps the originator's timestamp.
+ *
+ * Turnaround is timed with LongClock::nowTimePrecise (1/16 uSec.)
+ * Requires LongClock::isPreciseMode() while relaying, else packet is not relayed.
+ * Precise mode exists only in a build with HF_TIMER_IS_REAL: without it, FloodRelay never relays.
+ * Requires MsgReceived callback not deferred (see Radio.)
+ * Turnaround must exceed ISR latency plus relay decision: if missed, packet is not relayed (counted.)
+ *
+ * Pure class, no instances.
+ */
+class FloodRelay {
+public:
+	/*
+	 * Flood packets are those whose byte at typeOffset equals typeValue.
+	 * Installs own MsgReceived callback on Radio, which calls nextCallback after relaying.
+	 */
+	static void enable(uint8_t typeOffset, uint8_t typeValue,
+			uint8_t hopCountOffset, uint8_t maxHopCount,
+			PreciseTime turnaround, MsgReceivedCallback nextCallback);
+	// Restores nextCallback on Radio
+	static void disable();
+	static bool isEnabled();
+
+	static uint32_t countRelayed();
+	// Turnaround already past when relay was ready
+	static uint32_t countLate();
+};
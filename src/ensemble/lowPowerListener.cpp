@@ -0,0 +1,125 @@
+
+#include <cassert>
+
+#include "lowPowerListener.h"
+
+#include "ensemble.h"
+#include "../radio/radio.h"
+
+#include "../clock/longClock.h"
+#include "../clock/clockFacilitator.h"
+#include "../clock/taskTimer.h"
+#include "../services/eventQueue.h"
+
+
+namespace {
+
+OSTime _sampleDuration = 0;
+bool _isListening = false;
+
+uint32_t _countSamples = 0;
+uint32_t _countDetections = 0;
+
+
+/*
+ * Upper bound on time from address match to packet received.
+ * Packet is FixedPayloadCount plus CRC, at MegabitRate: ~60 uSec.
+ * Three ticks (30.5 uSec each) is at least 61 uSec, given tick granularity.
+ */
+const OSTime MaxPacketRemainder = 3;
+
+
+// Thread mode, via EventQueue
+void sampleTask() { (void) LowPowerListener::sampleChannel(); }
+
+/*
+ * When TaskTimer defers tasks, this is already in thread mode (dispatched from EventQueue): sample now.
+ * Else ISR context of TaskTimer, the single producer of priority Normal: post.
+ */
+void periodTask() {
+	if (TaskTimer::isTasksDeferred()) {
+		sampleTask();
+	}
+	else {
+		// If queue full, this sample is skipped.
+		(void) EventQueue::post(sampleTask, EventPriority::Normal);
+	}
+}
+
+
+/*
+ * Spin until deadline or condition.
+ * Spinning, not sleeping, since sample is shorter than sleep overhead.
+ */
+bool spinUntilPacketStartOrDeadline(LongTime deadline) {
+	while (LongClock::nowTime() < deadline) {
+		// Address matched, or already received (radio disabled on receive)
+		if (Radio::isReceiveInProgress() or not Ensemble::isRadioInUse()) return true;
+	}
+	return false;
+}
+
+void spinUntilPacketReceivedOrDeadline(LongTime deadline) {
+	while (Ensemble::isRadioInUse() and LongClock::nowTime() < deadline) {}
+}
+
+}	// namespace
+
+
+
+bool LowPowerListener::start(OSTime period, OSTime sampleDuration) {
+	assert(sampleDuration > 0);
+	assert(period > sampleDuration);
+
+	_sampleDuration = sampleDuration;
+	_countSamples = 0;
+	_countDetections = 0;
+	_isListening = TaskTimer::schedulePeriodic(periodTask, period);
+	return _isListening;
+}
+
+
+void LowPowerListener::stop() {
+	TaskTimer::cancel(periodTask);
+	_isListening = false;
+}
+
+
+bool LowPowerListener::isListening() { return _isListening; }
+
+
+bool LowPowerListener::sampleChannel() {
+	_countSamples++;
+
+	// Radio requires HFXO
+	ClockFacilitator::startHFXOAndSleepUntilRunning();
+	Radio::clearReceiveInProgress();
+	Ensemble::startReceiving();
+
+	bool result = false;
+	if (spinUntilPacketStartOrDeadline(LongClock::nowTime() + _sampleDuration)) {
+		// Extend sample into full receive of the packet
+		_countDetections++;
+		spinUntilPacketReceivedOrDeadline(LongClock::nowTime() + MaxPacketRemainder);
+		result = not Ensemble::isRadioInUse();
+	}
+
+	// Quiet channel, packet received, or packet lost: radio off until next sample
+	Ensemble::stopReceiving();
+	Ensemble::shutdown();
+	return result;
+}
+
+
+void LowPowerListener::transmitRepeatedly(OSTime duration) {
+	LongTime end = LongClock::nowTime() + duration;
+	do {
+		// Radio buffer is unchanged by transmit
+		Ensemble::transmitStaticSynchronously();
+	}
+	while (LongClock::nowTime() < end);
+}
+
+
+uint32_t LowPowerListener::countSamples() { return _countSamples; }
+uint32_t LowPowerListener::countDetections() { return _countDetections; }
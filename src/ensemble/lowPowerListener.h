@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../platformTypes.h"	// OSTime
+
+
+/*
+ * Low power listening: duty-cycled receive instead of long receive windows.
+ *
+ * Listener:
+ * Every period, wakes and samples the channel for a short duration.
+ * If no packet begins (no address match) radio is shutdown until next period.
+ * If a packet begins, the sample extends until the packet is received
+ * (MsgReceived callback of Radio is called as usual.)
+ *
+ * Sender:
+ * transmitRepeatedly() sends the same packet back to back for at least one listener period,
+ * so that some sample of every listener overlaps a whole packet.
+ *
+ * Sample duration must exceed one repeated packet (including rampup of sender)
+ * so that a sample that starts mid-packet still hears the next whole packet.
+ *
+ * Period is timed by TaskTimer (RTC compare.)
+ * Sampling is done in thread mode: the periodic Task posts to EventQueue (priority Normal)
+ * and IdleScheduler dispatches it, unless TaskTimer already defers Tasks to thread mode.
+ * Sampling starts HFXO, which blocks (sleeping.)
+ *
+ * Requires Ensemble configured, and HFXO not otherwise in use.
+ *
+ * Pure class, no instances.
+ */
+class LowPowerListener {
+public:
+	/*
+	 * Begin sampling every period, for sampleDuration ticks.
+	 * Requires period much greater than sampleDuration plus HFXO startup.
+	 * Returns false, and is not listening, if TaskTimer is full.
+	 */
+	static bool start(OSTime period, OSTime sampleDuration);
+	static void stop();
+	static bool isListening();
+
+	/*
+	 * Sample channel once, now.
+	 * Returns true if a packet was received (valid CRC or not.)
+	 * Ensemble is shutdown on return.
+	 *
+	 * Called by the periodic task via EventQueue, may be called directly.
+	 */
+	static bool sampleChannel();
+
+	/*
+	 * Sender side: transmit contents of radio buffer repeatedly, for at least duration ticks.
+	 * Blocks.
+	 * Requires Ensemble configured, and HFXO running (ClockFacilitator::startHFXOAndSleepUntilRunning().)
+	 */
+	static void transmitRepeatedly(OSTime duration);
+
+	/*
+	 * Statistics since start()
+	 */
+	static uint32_t countSamples();
+	static uint32_t countDetections();
+};
@@ -0,0 +1,236 @@
+
+#include <cassert>
+
+#include "radioArbiter.h"
+#include "timeslotSource.h"
+
+#include "../clock/longClock.h"
+
+
+namespace {
+
+const unsigned int None = RadioArbiter::MaxRequests;
+
+struct Pending {
+	TimeslotRequest request;
+	LongTime plannedStart;
+	bool isUsed;
+	bool isPlaced;	// during plan()
+};
+
+Pending pending[RadioArbiter::MaxRequests];
+
+// Pending request for which a timeslot is requested from source
+unsigned int requested = None;
+
+bool _isTimeslotActive = false;
+TimeslotRequest active;
+LongTime activeEnd;
+
+uint32_t granted = 0;
+uint32_t delayed = 0;
+uint32_t blocked = 0;
+
+
+/*
+ * Guard state against timeslotStarted/timeslotEnded, called in RTCx_IRQ.
+ * TaskTimer's critical section, since it nests: TimeslotSource uses TaskTimer within this one.
+ */
+void enterCriticalSection() { TaskTimer::enterCriticalSection(); }
+void exitCriticalSection()  { TaskTimer::exitCriticalSection(); }
+
+
+unsigned int indexOf(Task onStart) {
+	for (unsigned int i = 0; i < RadioArbiter::MaxRequests; i++) {
+		if (pending[i].isUsed and pending[i].request.onStart == onStart) return i;
+	}
+	return None;
+}
+
+/*
+ * Does a come before b in order of placement?
+ */
+bool placesBefore(const TimeslotRequest& a, const TimeslotRequest& b) {
+	if (a.priority != b.priority) return a.priority > b.priority;
+	return a.earliestStart < b.earliestStart;
+}
+
+/*
+ * Earliest start, not before candidate, not overlapping any placed.
+ * Each pass either finds no overlap, or moves past one placed, so at most MaxRequests passes.
+ */
+LongTime earliestFree(LongTime candidate, OSTime duration) {
+	bool isMoved = true;
+	while (isMoved) {
+		isMoved = false;
+		for (unsigned int i = 0; i < RadioArbiter::MaxRequests; i++) {
+			if (not pending[i].isUsed or not pending[i].isPlaced) continue;
+
+			LongTime placedEnd = pending[i].plannedStart + pending[i].request.duration;
+			if ((candidate < placedEnd) and (pending[i].plannedStart < candidate + duration)) {
+				candidate = placedEnd;
+				isMoved = true;
+			}
+		}
+	}
+	return candidate;
+}
+
+/*
+ * Place every pending request.  Returns index of earliest placed, or None.
+ */
+unsigned int plan() {
+	// Also from RTCx_IRQ
+	LongTime notBefore = LongClock::nowTimeISRSafe() + LongClock::MinTimeout;
+	if (_isTimeslotActive and activeEnd > notBefore) notBefore = activeEnd;
+
+	for (unsigned int i = 0; i < RadioArbiter::MaxRequests; i++) {
+		pending[i].isPlaced = false;
+	}
+
+	unsigned int result = None;
+	while (true) {
+		// Next to place
+		unsigned int next = None;
+		for (unsigned int i = 0; i < RadioArbiter::MaxRequests; i++) {
+			if (not pending[i].isUsed or pending[i].isPlaced) continue;
+			if ((next == None) or placesBefore(pending[i].request, pending[next].request)) next = i;
+		}
+		if (next == None) break;
+
+		Pending& placing = pending[next];
+		LongTime candidate = (placing.request.earliestStart > notBefore) ? placing.request.earliestStart : notBefore;
+		placing.plannedStart = earliestFree(candidate, placing.request.duration);
+		placing.isPlaced = true;
+
+		if ((result == None) or (placing.plannedStart < pending[result].plannedStart)) result = next;
+	}
+	return result;
+}
+
+/*
+ * Replan and request from source the earliest timeslot.
+ * While a timeslot is active, only plan: next is requested when it ends.
+ *
+ * Returns false if source refused the request.
+ * Then no timeslot is requested: pending requests wait for the next replan.
+ */
+bool replan() {
+	unsigned int earliest = plan();
+	if (_isTimeslotActive) return true;
+
+	if (earliest == None) {
+		requested = None;
+		TimeslotSource::cancel();
+		return true;
+	}
+
+	requested = earliest;
+	if (TimeslotSource::request(pending[earliest].plannedStart, pending[earliest].request.duration)) return true;
+
+	requested = None;
+	blocked++;
+	return false;
+}
+
+}	// namespace
+
+
+
+bool RadioArbiter::request(const TimeslotRequest& aRequest) {
+	assert(aRequest.onStart != nullptr);
+	assert(aRequest.onEnd != nullptr);
+	assert(aRequest.duration > 0);
+
+	enterCriticalSection();
+	assert(indexOf(aRequest.onStart) == None);
+
+	bool result = false;
+	for (unsigned int i = 0; i < MaxRequests; i++) {
+		if (pending[i].isUsed) continue;
+
+		pending[i].request = aRequest;
+		pending[i].isUsed = true;
+		result = replan();
+		if (not result) {
+			// Not pending after all.  Others stay pending, as after any refused replan.
+			pending[i].isUsed = false;
+			(void) replan();
+		}
+		break;
+	}
+	exitCriticalSection();
+	return result;
+}
+
+
+void RadioArbiter::cancel(Task onStart) {
+	enterCriticalSection();
+	unsigned int index = indexOf(onStart);
+	if (index != None) {
+		pending[index].isUsed = false;
+		(void) replan();
+	}
+	exitCriticalSection();
+}
+
+
+bool RadioArbiter::plannedStart(Task onStart, LongTime& start) {
+	enterCriticalSection();
+	unsigned int index = indexOf(onStart);
+	bool result = (index != None);
+	if (result) {
+		start = pending[index].plannedStart;
+	}
+	exitCriticalSection();
+	return result;
+}
+
+
+bool RadioArbiter::isTimeslotActive() { return _isTimeslotActive; }
+
+uint32_t RadioArbiter::countGranted() { return granted; }
+uint32_t RadioArbiter::countDelayed() { return delayed; }
+uint32_t RadioArbiter::countBlocked() { return blocked; }
+
+
+void RadioArbiter::timeslotStarted() {
+	assert(requested != None);
+	assert(not _isTimeslotActive);
+
+	// Pending becomes active
+	active = pending[requested].request;
+	LongTime now = LongClock::nowTimeISRSafe();
+	activeEnd = now + active.duration;
+	pending[requested].isUsed = false;
+	requested = None;
+	_isTimeslotActive = true;
+
+	granted++;
+	if (now > active.earliestStart + LongClock::MinTimeout) delayed++;
+
+	// Client configures radio
+	active.onStart();
+}
+
+
+void RadioArbiter::timeslotEnded() {
+	assert(_isTimeslotActive);
+
+	// Client stops using radio
+	active.onEnd();
+	_isTimeslotActive = false;
+
+	(void) replan();
+}
+
+
+void RadioArbiter::timeslotBlocked() {
+	assert(requested != None);
+	assert(not _isTimeslotActive);
+
+	// Request stays pending: request it again
+	requested = None;
+	blocked++;
+	(void) replan();
+}
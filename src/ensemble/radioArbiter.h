@@ -0,0 +1,84 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../clock/taskTimer.h"	// Task
+
+
+/*
+ * Request for a timeslot of exclusive use of the radio.
+ */
+struct TimeslotRequest {
+	LongTime earliestStart;
+	OSTime duration;
+	uint8_t priority;		// larger is more important
+	/*
+	 * Called at start of timeslot.  Client configures radio for its protocol.
+	 * Identifies the request (as a Task identifies itself to TaskTimer.)
+	 */
+	Task onStart;
+	// Called at end of timeslot.  On return, client must not be using radio.
+	Task onEnd;
+};
+
+
+/*
+ * Arbiter of radio among use cases (sequential multiprotocol.)
+ *
+ * Clients (e.g. SleepSync and a second protocol) request timeslots.
+ * Arbiter grants non-overlapping timeslots, packed tightly:
+ * in order of priority (then earliest start) each request is placed at the earliest time,
+ * not before its earliest start, that does not overlap a request already placed.
+ * Placement is recomputed whenever requests change, until the timeslot starts.
+ * A started timeslot is never preempted.
+ *
+ * Arbiter does not configure the radio: each client configures its own protocol in onStart.
+ * (RadioUseCase does not yet hold per-protocol configuration.)
+ *
+ * Each request is granted once: client requests again for its next timeslot (e.g. in onEnd.)
+ *
+ * Timeslots come from a TimeslotSource (SoftDevice, or a stand-in.)
+ * Callbacks are in ISR context.
+ * When the source refuses or blocks a timeslot (e.g. TaskTimer full)
+ * requests stay pending and are requested again when requests change or a timeslot ends or is blocked.
+ *
+ * Pure class, no instances.  Call from thread mode, or from a callback.
+ * State is guarded against the RTCx_IRQ (in which the stand-in TimeslotSource calls back)
+ * by TaskTimer's critical section, which nests.
+ */
+class RadioArbiter {
+public:
+	static const unsigned int MaxRequests = 4;
+
+	/*
+	 * Returns false if MaxRequests pending, or if TimeslotSource refused: then request is not pending.
+	 * Requires onStart not already pending.
+	 */
+	static bool request(const TimeslotRequest& request);
+
+	// Does nothing if not pending
+	static void cancel(Task onStart);
+
+	/*
+	 * Currently planned start of pending request.
+	 * Returns false if not pending.
+	 */
+	static bool plannedStart(Task onStart, LongTime& start);
+
+	static bool isTimeslotActive();
+
+	// Statistics
+	static uint32_t countGranted();
+	// Granted later than earliest start
+	static uint32_t countDelayed();
+	// Refused or blocked by TimeslotSource
+	static uint32_t countBlocked();
+
+	/*
+	 * From TimeslotSource
+	 */
+	static void timeslotStarted();
+	static void timeslotEnded();
+	// Requested timeslot will not start
+	static void timeslotBlocked();
+};
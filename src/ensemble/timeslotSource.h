@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../platformTypes.h"	// OSTime
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * Source of radio timeslots, used by RadioArbiter.
+ *
+ * With a SoftDevice, timeslots are granted by the SoftDevice timeslot API,
+ * and an implementation of this class wraps that API.
+ * timeslotStandIn.cpp implements it using TaskTimer, for builds (or hosts) without SoftDevice.
+ *
+ * At most one request outstanding: a new request replaces it.
+ * Source calls RadioArbiter::timeslotStarted() at start, and RadioArbiter::timeslotEnded() at start + duration,
+ * both in ISR context.
+ * If a requested timeslot can not start after all, source calls RadioArbiter::timeslotBlocked() instead.
+ *
+ * Pure class, no instances.
+ */
+class TimeslotSource {
+public:
+	// Returns false if refused: then none is outstanding.
+	static bool request(LongTime start, OSTime duration);
+	// Cancel request not yet started.  Does not end a started timeslot.
+	static void cancel();
+};
@@ -0,0 +1,52 @@
+
+#include <cassert>
+
+#include "timeslotSource.h"
+#include "radioArbiter.h"
+
+#include "../clock/taskTimer.h"
+
+
+/*
+ * Stand-in for the SoftDevice timeslot API: grants every request, on time.
+ * Uses TaskTimer for start and end: refuses, or blocks, only when TaskTimer is full.
+ */
+
+
+namespace {
+
+OSTime slotDuration;
+
+
+void endTask() {
+	RadioArbiter::timeslotEnded();
+}
+
+void startTask() {
+	// End first, so a started timeslot always ends even if arbiter requests another
+	if (TaskTimer::schedule(endTask, slotDuration)) {
+		RadioArbiter::timeslotStarted();
+	}
+	else {
+		// Could not end it, so do not start it
+		RadioArbiter::timeslotBlocked();
+	}
+}
+
+}	// namespace
+
+
+
+bool TimeslotSource::request(LongTime start, OSTime duration) {
+	assert(duration > 0);
+	assert(not TaskTimer::isScheduled(endTask));	// not while a timeslot is started
+
+	cancel();
+	slotDuration = duration;
+	return TaskTimer::scheduleAt(startTask, start);
+}
+
+
+void TimeslotSource::cancel() {
+	TaskTimer::cancel(startTask);
+}
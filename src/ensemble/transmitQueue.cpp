@@ -0,0 +1,138 @@
+
+#include <cassert>
+
+#include "transmitQueue.h"
+
+#include "ensemble.h"
+#include "../clock/longClock.h"
+
+
+namespace {
+
+struct QueuedPacket {
+	uint8_t payload[Radio::FixedPayloadCount];
+	TransmitPriority priority;
+	LongTime expiry;
+	TransmitPowerdBm power;
+	uint32_t order;		// of enqueue, for FIFO within priority
+	bool isUsed;
+};
+
+QueuedPacket packets[TransmitQueue::Capacity];
+uint32_t nextOrder = 0;
+unsigned int used = 0;
+uint32_t expired = 0;
+
+/*
+ * Upper bound on one transmitStaticSynchronously, in ticks (30.5 uSec.)
+ * Rampup at most 130 uSec, plus on air at MegabitRate about 20 bytes
+ * (preamble, address, FixedPayloadCount payload, CRC): 160 uSec.
+ * Total 290 uSec: 10 ticks.
+ */
+const OSTime TransmitDuration = 10;
+
+
+bool isExpired(const QueuedPacket& packet, LongTime now) {
+	return (packet.expiry != TransmitQueue::NoExpiry) and (packet.expiry <= now);
+}
+
+/*
+ * Does a precede b in sending order?
+ * Unsigned difference is correct across wrap of order.
+ */
+bool precedes(const QueuedPacket& a, const QueuedPacket& b) {
+	if (a.priority != b.priority) return a.priority < b.priority;
+	return (int32_t) (a.order - b.order) < 0;
+}
+
+/*
+ * Index of next packet to send, or Capacity if empty.
+ */
+unsigned int indexOfNext() {
+	unsigned int result = TransmitQueue::Capacity;
+	for (unsigned int i = 0; i < TransmitQueue::Capacity; i++) {
+		if (not packets[i].isUsed) continue;
+		if ((result == TransmitQueue::Capacity) or precedes(packets[i], packets[result])) result = i;
+	}
+	return result;
+}
+
+void removeAt(unsigned int index) {
+	packets[index].isUsed = false;
+	used--;
+}
+
+void copyToRadioBuffer(const QueuedPacket& packet) {
+	BufferPointer buffer = Ensemble::getBufferAddress();
+	for (unsigned int i = 0; i < Radio::FixedPayloadCount; i++) {
+		buffer[i] = packet.payload[i];
+	}
+}
+
+}	// namespace
+
+
+
+bool TransmitQueue::enqueue(const uint8_t* payload, TransmitPriority priority, LongTime expiry, TransmitPowerdBm power) {
+	assert(payload != nullptr);
+
+	for (unsigned int i = 0; i < Capacity; i++) {
+		if (packets[i].isUsed) continue;
+
+		QueuedPacket& packet = packets[i];
+		for (unsigned int j = 0; j < Radio::FixedPayloadCount; j++) {
+			packet.payload[j] = payload[j];
+		}
+		packet.priority = priority;
+		packet.expiry = expiry;
+		packet.power = power;
+		packet.order = nextOrder++;
+		packet.isUsed = true;
+		used++;
+		return true;
+	}
+	return false;
+}
+
+
+unsigned int TransmitQueue::drain(LongTime windowEnd) {
+	unsigned int result = 0;
+
+	while (true) {
+		LongTime now = LongClock::nowTime();
+		// Next transmit must complete within window
+		if (now + TransmitDuration > windowEnd) break;
+
+		unsigned int index = indexOfNext();
+		if (index == Capacity) break;
+
+		if (isExpired(packets[index], now)) {
+			expired++;
+		}
+		else {
+			copyToRadioBuffer(packets[index]);
+			Ensemble::transmitStaticSynchronously(packets[index].power);
+			result++;
+		}
+		removeAt(index);
+	}
+	return result;
+}
+
+
+void TransmitQueue::dropExpired() {
+	LongTime now = LongClock::nowTime();
+	for (unsigned int i = 0; i < Capacity; i++) {
+		if (packets[i].isUsed and isExpired(packets[i], now)) {
+			expired++;
+			removeAt(i);
+		}
+	}
+}
+
+
+bool TransmitQueue::isEmpty() { return used == 0; }
+
+unsigned int TransmitQueue::countQueued() { return used; }
+
+uint32_t TransmitQueue::countExpired() { return expired; }
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../radio/radio.h"	// FixedPayloadCount
+#include "../radioUseCase/radioUseCase.h"
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * Priority of queued packet.  Lower value is sent first.
+ */
+enum class TransmitPriority {
+	Sync = 0,	// sync beacons
+	Control,
+	Bulk		// work payloads
+};
+
+
+/*
+ * Queue of packets to transmit in the next radio-on window,
+ * instead of waking the radio for each.
+ *
+ * Packets are sent highest priority first, FIFO within a priority.
+ * A packet may have an expiry: if not sent by then, it is dropped (not sent.)
+ *
+ * Packets are copied in, and copied to the radio buffer when sent.
+ *
+ * Static capacity.  Pure class, no instances.  Thread mode only.
+ */
+class TransmitQueue {
+public:
+	static const unsigned int Capacity = 8;
+
+	// Expiry meaning never expires
+	static const LongTime NoExpiry = 0;
+
+	/*
+	 * Returns false if full (packet not queued.)
+	 * Default power is that of RadioUseCase at time of enqueue.
+	 */
+	static bool enqueue(const uint8_t* payload,
+			TransmitPriority priority,
+			LongTime expiry = NoExpiry,
+			TransmitPowerdBm power = RadioUseCase::defaultXmitPower());
+
+	/*
+	 * Transmit queued packets until empty, or until another would not complete by windowEnd.
+	 * Drops expired packets.
+	 * Requires Ensemble configured, HFXO running, and not receiving.
+	 * Overwrites radio buffer.
+	 * Returns count sent.
+	 */
+	static unsigned int drain(LongTime windowEnd);
+
+	// Drop expired packets without transmitting
+	static void dropExpired();
+
+	static bool isEmpty();
+	static unsigned int countQueued();
+	static uint32_t countExpired();
+};
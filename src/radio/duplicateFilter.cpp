@@ -0,0 +1,129 @@
+
+#include <cassert>
+
+#include "duplicateFilter.h"
+#include "radio.h"	// FixedPayloadCount
+
+
+namespace {
+
+static_assert((DuplicateFilter::Capacity & (DuplicateFilter::Capacity - 1)) == 0, "Capacity must be power of two");
+
+/*
+ * Key stored exactly: hash only chooses the slot.
+ * A hash collision then costs a probe step, not a wrongly dropped packet.
+ */
+struct Entry {
+	uint64_t sender;
+	uint32_t sequence;
+	uint32_t stamp;	// when recorded, in count of misses
+	bool isUsed;
+};
+
+Entry entries[DuplicateFilter::Capacity];
+
+bool _isEnabled = false;
+uint8_t _senderOffset;
+uint8_t _senderWidth;
+uint8_t _sequenceOffset;
+uint8_t _sequenceWidth;
+
+uint32_t hits = 0;
+uint32_t misses = 0;
+
+
+// Little endian, as MessageView
+uint64_t fieldOf(BufferPointer packet, uint8_t offset, uint8_t width) {
+	uint64_t result = 0;
+	for (unsigned int i = width; i > 0; i--) {
+		result = (result << 8) | packet[offset + i - 1];
+	}
+	return result;
+}
+
+/*
+ * FNV-1a over sender and sequence bytes.
+ */
+uint32_t hashBytes(uint32_t hash, BufferPointer bytes, uint8_t count) {
+	for (unsigned int i = 0; i < count; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+uint32_t hashOf(BufferPointer packet) {
+	uint32_t result = hashBytes(2166136261u, packet + _senderOffset, _senderWidth);
+	return hashBytes(result, packet + _sequenceOffset, _sequenceWidth);
+}
+
+unsigned int slotOf(uint32_t hash, unsigned int probe) {
+	return (hash + probe) & (DuplicateFilter::Capacity - 1);
+}
+
+}	// namespace
+
+
+
+void DuplicateFilter::enable(uint8_t senderOffset, uint8_t senderWidth, uint8_t sequenceOffset, uint8_t sequenceWidth) {
+	assert(senderOffset + senderWidth <= Radio::FixedPayloadCount);
+	assert(sequenceOffset + sequenceWidth <= Radio::FixedPayloadCount);
+	assert(senderWidth <= 8);
+	assert(sequenceWidth <= 4);
+
+	_senderOffset = senderOffset;
+	_senderWidth = senderWidth;
+	_sequenceOffset = sequenceOffset;
+	_sequenceWidth = sequenceWidth;
+	clear();
+	_isEnabled = true;
+}
+
+void DuplicateFilter::disable() { _isEnabled = false; }
+
+bool DuplicateFilter::isEnabled() { return _isEnabled; }
+
+
+void DuplicateFilter::clear() {
+	for (unsigned int i = 0; i < Capacity; i++) {
+		entries[i].isUsed = false;
+	}
+	hits = 0;
+	misses = 0;
+}
+
+
+bool DuplicateFilter::check(BufferPointer packet) {
+	assert(_isEnabled);
+
+	uint64_t sender = fieldOf(packet, _senderOffset, _senderWidth);
+	uint32_t sequence = fieldOf(packet, _sequenceOffset, _sequenceWidth);
+	uint32_t hash = hashOf(packet);
+
+	unsigned int victim = slotOf(hash, 0);
+	for (unsigned int probe = 0; probe < ProbeLength; probe++) {
+		unsigned int slot = slotOf(hash, probe);
+		if (not entries[slot].isUsed) {
+			// Key not further along probe: it would have filled this slot
+			victim = slot;
+			break;
+		}
+		if (entries[slot].sender == sender and entries[slot].sequence == sequence) {
+			hits++;
+			return true;
+		}
+		// Oldest so far.  Unsigned difference is correct across wrap of misses.
+		if ((misses - entries[slot].stamp) > (misses - entries[victim].stamp)) victim = slot;
+	}
+
+	entries[victim].sender = sender;
+	entries[victim].sequence = sequence;
+	entries[victim].stamp = misses;
+	entries[victim].isUsed = true;
+	misses++;
+	return false;
+}
+
+
+uint32_t DuplicateFilter::countHits() { return hits; }
+uint32_t DuplicateFilter::countMisses() { return misses; }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../platformTypes.h"	// BufferPointer
+
+
+/*
+ * Cache of recently received (sender, sequence) keys.
+ *
+ * Consulted by radioISR after CRC check: a packet whose key was recently seen
+ * is dropped, receive is restarted, and MsgReceived callback is not called.
+ * Thus copies of a flooded message, or from several masters, do not wake upper layer.
+ *
+ * Message format is the caller's (see messageView.h): enable() takes the offset and width
+ * of the sender field (typically a System::ID, up to 8 bytes) and of the sequence field (up to 4 bytes.)
+ * Sender and sequence are stored and compared exactly; their hash only chooses the slot.
+ *
+ * Fixed size, open addressing with short linear probe.
+ * When probe finds no free slot, the oldest entry in the probe is replaced.
+ * Thus a key is forgotten after roughly Capacity other keys.
+ *
+ * Default disabled.
+ *
+ * Pure class, no instances.  Call check() only from radioISR.
+ */
+class DuplicateFilter {
+public:
+	static const unsigned int Capacity = 16;	// power of two
+	static const unsigned int ProbeLength = 4;
+
+	/*
+	 * Enable, with locations of fields in payload.
+	 * Clears cache.
+	 */
+	static void enable(uint8_t senderOffset, uint8_t senderWidth, uint8_t sequenceOffset, uint8_t sequenceWidth);
+	static void disable();
+	static bool isEnabled();
+
+	static void clear();
+
+	/*
+	 * Returns true if (sender, sequence) of packet is in cache (a duplicate.)
+	 * Else records key and returns false.
+	 */
+	static bool check(BufferPointer packet);
+
+	static uint32_t countHits();	// duplicates
+	static uint32_t countMisses();	// first copies
+};
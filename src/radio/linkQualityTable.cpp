@@ -0,0 +1,142 @@
+
+#include <cassert>
+
+#include "linkQualityTable.h"
+#include "radio.h"	// FixedPayloadCount
+
+
+namespace {
+
+LinkQuality entries[LinkQualityTable::Capacity];
+unsigned int countUsed = 0;
+
+/*
+ * Averages kept with 4 more fractional bits than reported.
+ */
+uint16_t rssiAverage[LinkQualityTable::Capacity];
+uint16_t failureAverage[LinkQualityTable::Capacity];
+const unsigned int AverageFractionBits = 4;
+
+// Weight of newest sample is 1/(2^WeightShift)
+const unsigned int WeightShift = 3;
+
+bool _isEnabled = false;
+uint8_t _senderOffset;
+uint8_t _senderWidth;
+
+uint32_t unattributed = 0;
+
+
+SystemID senderOf(BufferPointer packet) {
+	SystemID result = 0;
+	for (unsigned int i = _senderWidth; i > 0; i--) {
+		result = (result << 8) | packet[_senderOffset + i - 1];
+	}
+	return result;
+}
+
+/*
+ * Index of id, or Capacity if absent.
+ */
+unsigned int indexOf(SystemID id) {
+	for (unsigned int i = 0; i < countUsed; i++) {
+		if (entries[i].id == id) return i;
+	}
+	return LinkQualityTable::Capacity;
+}
+
+/*
+ * Free slot, else least recently heard.
+ */
+unsigned int slotForNew() {
+	if (countUsed < LinkQualityTable::Capacity) return countUsed++;
+
+	unsigned int result = 0;
+	for (unsigned int i = 1; i < LinkQualityTable::Capacity; i++) {
+		if (entries[i].lastHeard < entries[result].lastHeard) result = i;
+	}
+	return result;
+}
+
+/*
+ * average += (sample - average) / 2^WeightShift, in signed arithmetic.
+ */
+uint16_t weigh(uint16_t average, uint16_t sample) {
+	int32_t difference = (int32_t) sample - (int32_t) average;
+	return (uint16_t) ((int32_t) average + difference / (1 << WeightShift));
+}
+
+}	// namespace
+
+
+
+void LinkQualityTable::enable(uint8_t senderOffset, uint8_t senderWidth) {
+	assert(senderWidth > 0 and senderWidth <= sizeof(SystemID));
+	assert(senderOffset + senderWidth <= Radio::FixedPayloadCount);
+
+	_senderOffset = senderOffset;
+	_senderWidth = senderWidth;
+	clear();
+	_isEnabled = true;
+}
+
+void LinkQualityTable::disable() { _isEnabled = false; }
+
+bool LinkQualityTable::isEnabled() { return _isEnabled; }
+
+void LinkQualityTable::clear() {
+	countUsed = 0;
+	unattributed = 0;
+}
+
+
+void LinkQualityTable::update(BufferPointer packet, bool isCRCValid, uint8_t rssi, LongTime timeOfArrival) {
+	assert(_isEnabled);
+
+	SystemID sender = senderOf(packet);
+	unsigned int index = indexOf(sender);
+	uint16_t failureSample = isCRCValid ? 0 : (255 << AverageFractionBits);
+	uint16_t rssiSample = rssi << AverageFractionBits;
+
+	if (index == Capacity) {
+		if (not isCRCValid) {
+			unattributed++;
+			return;
+		}
+		index = slotForNew();
+		entries[index].id = sender;
+		entries[index].countHeard = 0;
+		// First sample is the average
+		rssiAverage[index] = rssiSample;
+		failureAverage[index] = failureSample;
+	}
+	else {
+		rssiAverage[index] = weigh(rssiAverage[index], rssiSample);
+		failureAverage[index] = weigh(failureAverage[index], failureSample);
+	}
+
+	LinkQuality& quality = entries[index];
+	quality.rssi = rssiAverage[index] >> AverageFractionBits;
+	quality.crcFailureRatio = failureAverage[index] >> AverageFractionBits;
+	quality.countHeard++;
+	quality.lastHeard = timeOfArrival;
+}
+
+
+bool LinkQualityTable::find(SystemID id, LinkQuality& quality) {
+	unsigned int index = indexOf(id);
+	if (index == Capacity) return false;
+
+	quality = entries[index];
+	return true;
+}
+
+
+unsigned int LinkQualityTable::countEntries() { return countUsed; }
+
+const LinkQuality& LinkQualityTable::entry(unsigned int index) {
+	assert(index < countUsed);
+	return entries[index];
+}
+
+uint32_t LinkQualityTable::countUnattributed() { return unattributed; }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../platformTypes.h"	// SystemID, BufferPointer
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * Quality of link from one neighbor.
+ */
+struct LinkQuality {
+	SystemID id;
+	// Average RSSI, as magnitude of negative dBm: larger is weaker
+	uint8_t rssi;
+	// Average fraction of packets with CRC failure, in 1/256
+	uint8_t crcFailureRatio;
+	uint32_t countHeard;
+	LongTime lastHeard;
+};
+
+
+/*
+ * Neighbor table: link quality per sender, updated by radioISR for every packet.
+ *
+ * Averages are exponentially weighted (weight of newest is 1/8.)
+ *
+ * CRC failure heuristic: a packet with invalid CRC has an unreliable sender field.
+ * It is attributed to a neighbor only if its sender field matches one already in table
+ * (bit errors elsewhere in packet), else it is not attributed and creates no entry.
+ *
+ * Fixed capacity.  When full, the least recently heard neighbor is evicted.
+ *
+ * Message format is the caller's (see messageView.h): enable() takes the offset and width of the sender field.
+ * Default disabled.
+ *
+ * Pure class, no instances.  Readers in thread mode may see an entry mid-update.
+ */
+class LinkQualityTable {
+public:
+	static const unsigned int Capacity = 8;
+
+	// Sender field of at most 8 bytes, little endian
+	static void enable(uint8_t senderOffset, uint8_t senderWidth);
+	static void disable();
+	static bool isEnabled();
+
+	static void clear();
+
+	// From radioISR
+	static void update(BufferPointer packet, bool isCRCValid, uint8_t rssi, LongTime timeOfArrival);
+
+	/*
+	 * Returns false if id not in table.
+	 */
+	static bool find(SystemID id, LinkQuality& quality);
+
+	/*
+	 * Iterate: index in [0, countEntries())
+	 */
+	static unsigned int countEntries();
+	static const LinkQuality& entry(unsigned int index);
+
+	// CRC failures not attributable to a neighbor
+	static uint32_t countUnattributed();
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "radio.h"	// FixedPayloadCount, BufferPointer
+
+
+/*
+ * Typed view over a message in place in the radio buffer.
+ *
+ * Upper layers build and parse packets directly in the buffer the radio DMA's,
+ * instead of serializing into a separate buffer and copying.
+ *
+ * Layout is compile time:
+ * - each field is a MessageField of byte offset and width
+ * - NextField<> places a field after another, so offsets are computed, not hand counted
+ * - a field beyond the view's length, or a view longer than Radio::FixedPayloadCount, does not compile
+ *
+ * Multi-byte fields are little endian on air, independent of mcu endianness.
+ * Access is bytewise since fields are not aligned (Cortex-M0 faults on unaligned access.)
+ *
+ * Example, for SleepSync (1 MessageType + 6 MasterID + 3 offset + 1 WorkPayload):
+ *
+ *   typedef MessageField<0, 1> TypeField;
+ *   typedef NextField<TypeField, 6> MasterIDField;
+ *   typedef NextField<MasterIDField, 3> OffsetField;
+ *   typedef NextField<OffsetField, 1> WorkField;
+ *   typedef MessageView<WorkField::End> SyncView;
+ *
+ *   SyncView view = SyncView::overRadioBuffer();
+ *   view.set<MasterIDField>(myID);
+ *   if (view.get<TypeField>() == ...)
+ *
+ * Radio itself does not know the message format.
+ * Radio services that read fields in radioISR (e.g. DuplicateFilter)
+ * are given field offsets by the caller, e.g. a MessageField's Start and Size.
+ *
+ * View does not own the buffer.  Valid only while radio is not using buffer (see Radio algebra.)
+ */
+
+
+/*
+ * Smallest unsigned integer type holding Width bytes.
+ */
+template <unsigned int Width> struct FieldValueType { typedef uint64_t Type; };
+template <> struct FieldValueType<1> { typedef uint8_t Type; };
+template <> struct FieldValueType<2> { typedef uint16_t Type; };
+template <> struct FieldValueType<3> { typedef uint32_t Type; };
+template <> struct FieldValueType<4> { typedef uint32_t Type; };
+
+
+template <unsigned int Offset, unsigned int Width>
+struct MessageField {
+	static_assert(Width >= 1 and Width <= 8, "Field width must be 1 to 8 bytes");
+
+	static const unsigned int Start = Offset;
+	static const unsigned int Size = Width;
+	static const unsigned int End = Offset + Width;	// offset of following byte
+
+	typedef typename FieldValueType<Width>::Type ValueType;
+};
+
+
+/*
+ * Field immediately following Prior.
+ */
+template <typename Prior, unsigned int Width>
+using NextField = MessageField<Prior::End, Width>;
+
+
+
+template <unsigned int Length>
+class MessageView {
+	static_assert(Length <= Radio::FixedPayloadCount, "Message longer than radio payload");
+
+	BufferPointer buffer;
+
+public:
+	static const unsigned int Count = Length;
+
+	explicit MessageView(BufferPointer aBuffer) : buffer(aBuffer) {}
+
+	static MessageView overRadioBuffer() { return MessageView(Radio::getBufferAddress()); }
+
+
+	template <typename Field>
+	typename Field::ValueType get() const {
+		static_assert(Field::End <= Length, "Field beyond message");
+
+		typename Field::ValueType result = 0;
+		// Most significant byte last on air
+		for (unsigned int i = Field::Size; i > 0; i--) {
+			result = (result << 8) | buffer[Field::Start + i - 1];
+		}
+		return result;
+	}
+
+	/*
+	 * Bits of value wider than field are discarded.
+	 */
+	template <typename Field>
+	void set(typename Field::ValueType value) {
+		static_assert(Field::End <= Length, "Field beyond message");
+
+		for (unsigned int i = 0; i < Field::Size; i++) {
+			buffer[Field::Start + i] = (uint8_t) value;
+			value >>= 8;
+		}
+	}
+};
@@ -7,6 +7,11 @@
 #include <drivers/nvic/nvicRaw.h>	// nRF5x
 
 #include "radioData.h"
+#include "duplicateFilter.h"
+#include "linkQualityTable.h"
+
+#include "../services/eventQueue.h"
+#include "../services/logger.h"
 
 // platform lib e.g. nRF5x
 #include <drivers/radio/radio.h>
@@ -49,9 +54,16 @@
  */
 RadioDevice RadioData::device;
 void (*RadioData::aRcvMsgCallback)() = nullptr;
+bool RadioData::isRcvMsgCallbackDeferred = false;
 LongTime RadioData::_timeOfArrival;
+LongTime RadioData::_timeOfTransmit;
+PreciseTime RadioData::_preciseTimeOfTransmit;
+TransmitStamper RadioData::aTransmitStamper = nullptr;
+PreciseTime RadioData::_preciseTimeOfArrival;
 RadioState RadioData::state;
 volatile uint8_t RadioData::radioBuffer[Radio::FixedPayloadCount];
+RadioStatistics RadioData::statistics;	// zeroed as static
+LongTime RadioData::onSince;
 
 
 
@@ -81,33 +93,63 @@ void Radio::radioISR(void)
     	 * Timestamp packet ASAP.
     	 * For every packet, including those with CRC errors.
     	 */
-    	RadioData::_timeOfArrival = LongClock::nowTime();
+    	RadioData::_timeOfArrival = LongClock::nowTimeISRSafe();
+    	if (LongClock::isPreciseMode()) RadioData::_preciseTimeOfArrival = LongClock::nowTimePrecise();
 
     	assert(RadioData::state == Receiving);	// sanity
 
     	clearEventForMsgReceivedInterrupt();
 
+    	// Window is closed by packet: radio is disabled
+    	RadioData::statistics.received++;
+    	bool isCRCValid = RadioData::device.isCRCValid();
+    	if (not isCRCValid) RadioData::statistics.crcFailures++;
+    	RadioData::statistics.rxOnTime += RadioData::_timeOfArrival - RadioData::onSince;
+    	RadioData::state = Idle;
+
+    	// Ack even a duplicate: sender retransmits when it missed our ack
+    	if (isCRCValid and isAckMode()) transmitAckIfRequested();
+
     	// ledLogger2.toggleLED(2);	// debug: LED 2 show every receive
 
-    	/*
-    	 * Call next layer.
-    	 * For SleepSyncAgent calls Sleeper::msgReceivedCallback() which sets reasonForWake
-    	 */
-    	assert(RadioData::aRcvMsgCallback!=nullptr);
-    	RadioData::aRcvMsgCallback();
+    	// Every packet, including duplicates and CRC failures, informs link quality
+    	if (LinkQualityTable::isEnabled()) {
+    		LinkQualityTable::update(RadioData::radioBuffer, isCRCValid, receivedSignalStrength(), RadioData::_timeOfArrival);
+    	}
+
+    	if (isCRCValid and DuplicateFilter::isEnabled() and DuplicateFilter::check(RadioData::radioBuffer)) {
+    		// Drop copy without waking next layer: continue receiving, in the same window
+    		restartReceive();
+    	}
+    	else {
+    		/*
+    		 * Call next layer.
+    		 * For SleepSyncAgent calls Sleeper::msgReceivedCallback() which sets reasonForWake
+    		 */
+    		assert(RadioData::aRcvMsgCallback!=nullptr);
+    		if (RadioData::isRcvMsgCallbackDeferred) {
+    			// Called later in thread mode.  If EventQueue is full, packet is lost (and counted.)
+    			(void) EventQueue::post(RadioData::aRcvMsgCallback, EventPriority::High);
+    		}
+    		else {
+    			RadioData::aRcvMsgCallback();
+    		}
+    	}
     }
     else
     {
         /*
-         * Probable programming error.
+         * Probable programming error, or a glitch.
          * We were awakened by a radio event other than the only enabled interrupt 'MsgReceived'
          * (which on some platforms is radio DISABLED)
          * Brownout and bus faults (DMA?) could come while mcu is sleeping.
 		 * Invalid op code faults can not come while mcu is sleeping.
+		 *
+		 * Formerly assert(false), but reset costs LFXO restart and resync.
+		 * Recover instead.
          */
-    	// FUTURE handle more gracefully by just clearing all events???
-    	// FUTURE recover by raising exception and recovering by reset?
-    	assert(false);
+    	RadioData::statistics.spuriousInterrupts++;
+    	recoverFromUnexpectedEvent();
     }
     // We don't have a queue and we don't have a callback for idle
     assert(!isEventForMsgReceivedInterrupt());	// Ensure event is clear else get another unexpected interrupt
@@ -117,6 +159,66 @@ void Radio::radioISR(void)
 
 LongTime Radio::timeOfArrival() { return RadioData::_timeOfArrival; }
 
+LongTime Radio::timeOfTransmit() { return RadioData::_timeOfTransmit; }
+
+PreciseTime Radio::preciseTimeOfTransmit() {
+	return LongClock::isPreciseMode() ? RadioData::_preciseTimeOfTransmit : LongClock::preciseFromLongTime(RadioData::_timeOfTransmit);
+}
+
+void Radio::setTransmitStamper(TransmitStamper stamper) { RadioData::aTransmitStamper = stamper; }
+TransmitStamper Radio::transmitStamper() { return RadioData::aTransmitStamper; }
+
+
+PreciseTime Radio::preciseTimeOfArrival() {
+	// Before precise mode, coarse
+	return LongClock::isPreciseMode() ? RadioData::_preciseTimeOfArrival : LongClock::preciseFromLongTime(RadioData::_timeOfArrival);
+}
+
+
+/*
+ * In ISR.
+ * Clear whatever event caused interrupt, leave only MsgReceived interrupt as it was.
+ * If configuration was corrupted, abandon any receive and reconfigure.
+ */
+void Radio::recoverFromUnexpectedEvent() {
+	bool wasEnabledMsgReceived = RadioData::device.isEnabledInterruptForDisabledEvent();
+
+	/*
+	 * Only DISABLED (MsgReceived) interrupt is ever enabled, and END (PacketDone) if configured so.
+	 * DISABLED is not the cause (else radioISR handled a packet.)
+	 * ADDRESS is not cleared: isReceiveInProgress() relies on it.
+	 */
+	RadioData::device.disableInterruptForDisabledEvent();
+#ifdef PACKET_DONE_INTERRUPT
+	RadioData::device.disableInterruptForPacketDoneEvent();
+	RadioData::device.clearPacketDoneEvent();
+#endif
+
+	if (not isConfiguredForSleepSync()) {
+		RadioData::statistics.reconfigurations++;
+
+		// Configuration requires disabled
+		if (not RadioData::device.isDisabledState()) {
+			RadioData::device.startDisablingTask();
+			spinUntilDisabled();
+			RadioData::device.clearDisabledEvent();
+		}
+		if (RadioData::state == Receiving) {
+			// Receive window lost.  Caller's timeout will expire.
+			accumulateOnTime(RadioData::statistics.rxOnTime);
+		}
+		RadioData::state = Idle;
+		configurePhysicalProtocol();
+		// Xmit power not restored here, see RadioUseCase
+		NvicRaw::disableRadioIRQ();
+	}
+	else if (wasEnabledMsgReceived) {
+		// Still receiving, restore interrupt for packet
+		RadioData::device.enableInterruptForDisabledEvent();
+	}
+	// else transmitting (spinning) or idle: interrupt stays disabled
+}
+
 
 
 /*
@@ -210,6 +312,10 @@ void Radio::setMsgReceivedCallback(void (*onRcvMsgCallback)()){
 	RadioData::aRcvMsgCallback = onRcvMsgCallback;
 }
 
+void Radio::setMsgReceivedCallbackDeferred(bool isDeferred){
+	RadioData::isRcvMsgCallbackDeferred = isDeferred;
+}
+
 
 
 void Radio::abortUse() {
@@ -358,25 +464,79 @@ void Radio::transmitStaticSynchronously(){
 
 	// Lag for rampup, i.e. not on air immediately
 	transmitStatic();
+	spinUntilAddressTransmitted();
 	// FUTURE: sleep while xmitting to save power
 	spinUntilXmitComplete();
 	// assert xmit is complete and device is disabled
 }
 
 
+void Radio::transmitStaticSynchronously(TransmitPowerdBm power){
+	// Radio is disabled, so power is configurable
+	configureXmitPowerIfChanged(power);
+	transmitStaticSynchronously();
+}
+
+
+void Radio::transmitStaticSynchronouslyFromCallback(){
+	assert(RadioData::device.isDisabledState());	// packet received
+
+	disableInterruptForMsgReceived();
+	transmitStaticSynchronously();
+	setupInterruptForMsgReceivedEvent();
+}
+
+
+/*
+ * ADDRESS event (same event as for receive in progress) marks end of preamble and address on air.
+ * Spin on it (instead of only on DISABLED) to timestamp the transmit independently of code path.
+ */
+void Radio::spinUntilAddressTransmitted() {
+	/*
+	 * Until ADDRESS, timestamp is start of rampup: never the prior packet's.
+	 */
+	RadioData::_timeOfTransmit = RadioData::onSince;
+	if (LongClock::isPreciseMode()) RadioData::_preciseTimeOfTransmit = LongClock::preciseFromLongTime(RadioData::onSince);
+
+	// Radio stays in DISABLED state briefly after TXEN task: do not mistake it for disabled before ADDRESS
+	while (RadioData::device.isDisabledState() and not RadioData::device.isReceiveInProgressEvent()) {}
+
+	while (not RadioData::device.isReceiveInProgressEvent()) {
+		// If radio disabled before ADDRESS, something is wrong: do not spin forever
+		if (RadioData::device.isDisabledState()) return;
+	}
+	RadioData::_timeOfTransmit = LongClock::nowTimeISRSafe();
+	if (LongClock::isPreciseMode()) RadioData::_preciseTimeOfTransmit = LongClock::nowTimePrecise();
+	RadioData::device.clearReceiveInProgressEvent();
+}
+
+
 // Private, called only above
 void Radio::transmitStatic(){
 	RadioData::state = Transmitting;
+	RadioData::statistics.transmitted++;
+	RadioData::onSince = LongClock::nowTimeISRSafe();
 	setupFixedDMA();
+	RadioData::device.clearReceiveInProgressEvent();	// ADDRESS event, see spinUntilAddressTransmitted()
+	// Last moment before start: stamper's time excludes caller's code path
+	if (RadioData::aTransmitStamper != nullptr) RadioData::aTransmitStamper(RadioData::radioBuffer);
 	startXmit();
 	// not assert xmit is complete, i.e. asynchronous and non-blocking
 }
 
 
 void Radio::receiveStatic() {
+	RadioData::statistics.rxWindowsOpened++;
+	restartReceive();
+}
+
+void Radio::restartReceive() {
 	RadioData::state = Receiving;
+	RadioData::onSince = LongClock::nowTimeISRSafe();
 	setupFixedDMA();
 	setupInterruptForMsgReceivedEvent();
+	// ADDRESS event of a prior packet would count as receive in progress, see stopReceive()
+	RadioData::device.clearReceiveInProgressEvent();
 	startRcv();
 	// assert will get IRQ on message received
 }
@@ -494,6 +654,12 @@ void Radio::startRcv() {
 }
 
 void Radio::stopReceive() {
+	beginStopReceive();
+	completeStopReceive();
+}
+
+
+void Radio::beginStopReceive() {
 	/*
 	 *  assert radio state is:
 	 * RXRU : aborting before ramp-up complete
@@ -505,19 +671,38 @@ void Radio::stopReceive() {
 	disableInterruptForMsgReceived();
 	//isReceiving = false;
 
+	if (RadioData::state == Receiving) {
+		// No packet since receiveStatic(), else radioISR set Idle
+		RadioData::statistics.rxWindowsEmpty++;
+		accumulateOnTime(RadioData::statistics.rxOnTime);
+	}
+
 	if (! RadioData::device.isDisabledState()) {
+		if (RadioData::device.isReceiveInProgressEvent()) RadioData::statistics.abortsMidPacket++;
+
 		// was receiving and no messages received (device in state RXRU, etc. but not in state DISABLED)
 		RadioData::device.startDisablingTask();
 		// assert radio state soon RXDISABLE and then immediately transitions to DISABLED
-		spinUntilDisabled();
-		// DISABLED event was just set, clear it now before we later enable interrupts for it
-		RadioData::device.clearMsgReceivedEvent();
 	}
 
+	// Not Receiving, not yet Idle: see completeStopReceive()
+	RadioData::state = Disabling;
+}
+
+
+bool Radio::isStopReceiveComplete() { return RadioData::device.isDisabledState(); }
+
+
+void Radio::completeStopReceive() {
+	assert(RadioData::state == Disabling);
+
+	spinUntilDisabled();
+
 	/*
 	 * The above checked a state returned by the radio,
 	 * which experience shows can differ from the event for the state.
 	 * So here we explicitly clear the event to ensure it corresponds with radio state.
+	 * (DISABLED event was set if we started disabling, clear it now before we later enable interrupts for it.)
 	 */
 	RadioData::device.clearMsgReceivedEvent();
 
@@ -554,6 +739,8 @@ void Radio::spinUntilXmitComplete() {
 	 */
 	spinUntilDisabled();	// Disabled state means xmit done because using shortcuts
 
+	if (RadioData::state == Transmitting) accumulateOnTime(RadioData::statistics.txOnTime);
+
 	// EVENTS_DISABLED is set, leave it set but clear it before enabling interrupt on it
 
 	RadioData::state = Idle;
@@ -567,3 +754,28 @@ unsigned int Radio::receivedSignalStrength() {
 
 
 
+const RadioStatistics& Radio::statistics() { return RadioData::statistics; }
+
+void Radio::resetStatistics() { RadioData::statistics = RadioStatistics(); }
+
+void Radio::accumulateOnTime(LongTime& onTime) {
+	onTime += LongClock::nowTimeISRSafe() - RadioData::onSince;
+}
+
+void Radio::logStatistics() {
+	const RadioStatistics& stats = RadioData::statistics;
+	RTTLogger::log(" rx:"); RTTLogger::log(stats.received);
+	RTTLogger::log(" crcFail:"); RTTLogger::log(stats.crcFailures);
+	RTTLogger::log(" spurious:"); RTTLogger::log(stats.spuriousInterrupts);
+	RTTLogger::log(" reconfig:"); RTTLogger::log(stats.reconfigurations);
+	RTTLogger::log(" windows:"); RTTLogger::log(stats.rxWindowsOpened);
+	RTTLogger::log(" empty:"); RTTLogger::log(stats.rxWindowsEmpty);
+	RTTLogger::log(" aborts:"); RTTLogger::log(stats.abortsMidPacket);
+	RTTLogger::log(" tx:"); RTTLogger::log(stats.transmitted);
+	RTTLogger::log(" acks:"); RTTLogger::log(stats.acksSent);
+	RTTLogger::log(" ackRetries:"); RTTLogger::log(stats.ackRetries);
+	RTTLogger::log(" ackFails:"); RTTLogger::log(stats.ackFailures);
+	RTTLogger::log(" rxOn:"); RTTLogger::log((uint64_t) stats.rxOnTime);
+	RTTLogger::log(" txOn:"); RTTLogger::log((uint64_t) stats.txOnTime);
+	RTTLogger::log("\n");
+}
@@ -3,6 +3,7 @@
 #include <inttypes.h>
 
 #include "radioXmitPower.h"
+#include "radioStatistics.h"
 
 // platform lib e.g. nRF5x
 //#include <drivers/radio/radio.h>
@@ -16,11 +17,27 @@
 
 
 
+/*
+ * Acknowledged transfer, see Radio::setAckHandlers().
+ *
+ * AckMaker: receiver, in ISR.  Fill ack from received packet, return true if ack should be sent.
+ * AckMatcher: sender.  Return true if ack acknowledges sent packet.
+ */
+typedef bool (*AckMaker)(BufferPointer received, BufferPointer ack);
+typedef bool (*AckMatcher)(BufferPointer sent, BufferPointer ack);
+
+/*
+ * Writes a timestamp into packet, see Radio::setTransmitStamper().
+ */
+typedef void (*TransmitStamper)(BufferPointer packet);
+
+
 // XXX enum class
 typedef enum {
 	Receiving,
 	Transmitting,
 	Idle,
+	Disabling,	// after beginStopReceive(), until completeStopReceive()
 	PowerOff
 }RadioState;
 
@@ -52,7 +69,7 @@ enum class RadioPowerState {
  * Protocol is defined by:
  * - constants for lengths, channels, bitrate
  * - behaviour
- * -- no acks xmitted as in ESB
+ * -- no acks xmitted as in ESB, unless ack mode (see setAckHandlers())
  * -- all units use one address
  *
  * Singleton, all static class methods.
@@ -152,6 +169,7 @@ public:
 	 * TODO why not use above 2480?
 	 */
 	static const uint8_t FrequencyIndex = 80;
+	static const uint8_t MaxFrequencyIndex = 100;
 
 
 
@@ -163,6 +181,13 @@ public:
 	 */
 	static void setMsgReceivedCallback(void (*onRcvMsgCallback)());
 
+	/*
+	 * When deferred, radioISR only timestamps and posts the callback to EventQueue (priority High.)
+	 * The callback is then called in thread mode, not at interrupt priority.
+	 * Default not deferred.
+	 */
+	static void setMsgReceivedCallbackDeferred(bool isDeferred);
+
 
 	/*
 	 * These are generic.
@@ -188,7 +213,33 @@ public:
 
 
 
+	/*
+	 * Frequency is FrequencyIndex unless set otherwise.
+	 * All units must use the same frequency (e.g. one unit chooses by quietestChannel() and announces it.)
+	 * Setting reconfigures, so requires not in use.
+	 */
+	static void setFrequencyIndex(uint8_t index);
+	static uint8_t frequencyIndex();
+
+#ifdef RSSI_TASK_IS_REAL
+	/*
+	 * Spectrum scan.  Blocks, spinning for dwell ticks per channel.
+	 * Requires not in use, HFXO running.
+	 * Disables interrupt for MsgReceived (receiveStatic() enables it again.)
+	 *
+	 * Requires platform support (nRF5x RadioDevice RSSI start task and end event), build with RSSI_TASK_IS_REAL.
+	 *
+	 * energyMap[i] is RSSI of strongest sample on channel firstIndex+i,
+	 * as magnitude of negative dBm: larger is quieter.
+	 */
+	static void scanChannels(uint8_t firstIndex, uint8_t lastIndex, OSTime dwell, uint8_t* energyMap);
+	// Of candidates (e.g. 2, 26, 80) the frequency index having least energy.  Does not set it.
+	static uint8_t quietestChannel(const uint8_t* candidates, uint8_t count, OSTime dwell);
+#endif
+
 	static void configureXmitPower(TransmitPowerdBm power);
+	// Skips register write when power unchanged
+	static void configureXmitPowerIfChanged(TransmitPowerdBm power);
 	static TransmitPowerdBm getXmitPower();
 	// Runtime validity check of OTA value
 	static bool isValidXmitPower(TransmitPowerdBm power);
@@ -226,8 +277,16 @@ public:
 
 	// Static: buffer owned by radio, of fixed length
 	static void transmitStaticSynchronously();	// blocking
+	// At given power, which persists for later transmits
+	static void transmitStaticSynchronously(TransmitPowerdBm power);
 	static void spinUntilXmitComplete();
 	static void stopXmit();
+	/*
+	 * From MsgReceived callback (in radioISR), e.g. to relay the received packet.  Blocking, at current power.
+	 * Spins with interrupt for MsgReceived disabled, then restores it with the transmit's event cleared,
+	 * else radioISR is entered again as if spurious (as for an ack, see transmitAckIfRequested().)
+	 */
+	static void transmitStaticSynchronouslyFromCallback();
 
 	static void receiveStatic();
 	// Only returns true once, until after startReceive again.
@@ -236,9 +295,36 @@ public:
 	static void spinUntilReceiveComplete();
 	static void stopReceive();
 
+	/*
+	 * stopReceive() in two parts, so caller need not spin until device is disabled.
+	 * begin is non-blocking.  complete spins (briefly, if at all) until disabled.
+	 *    beginStopReceive(), <other work or sleep>, completeStopReceive(), <next radio operation>
+	 * Must complete before any other radio operation.
+	 */
+	static void beginStopReceive();
+	static bool isStopReceiveComplete();
+	static void completeStopReceive();
+
 	static bool isEnabledInterruptForMsgReceived();
 	static bool isEnabledInterruptForEndTransmit();
 
+	/*
+	 * Ack mode.  Optional, default off.
+	 *
+	 * Receiver: when set, radioISR calls maker for each packet with valid CRC,
+	 * and if it returns true, transmits the ack before calling MsgReceived callback.
+	 * Received packet stays in radio buffer (ack has its own buffer.)
+	 * Pass nullptr maker to turn off.
+	 *
+	 * Sender: transmitWithAck() transmits radio buffer, then receives for ackTimeout ticks,
+	 * and retransmits until matcher accepts an ack or maxAttempts.
+	 * Blocks.  Returns true if acked.
+	 * ackTimeout must cover receiver's turnaround plus ack airtime: a few ticks.
+	 */
+	static void setAckHandlers(AckMaker maker, AckMatcher matcher);
+	static bool isAckMode();
+	static bool transmitWithAck(unsigned int maxAttempts, OSTime ackTimeout);
+
 #ifdef DYNAMIC
 	static void transmit(BufferPointer data, uint8_t length);
 	static void transmitSynchronously(BufferPointer data, uint8_t length);
@@ -252,8 +338,34 @@ public:
 	 */
 	static bool isPacketCRCValid();
 	static LongTime timeOfArrival();
+	// Resolution of LongClock::nowTimePrecise() if precise mode, else of timeOfArrival()
+	static PreciseTime preciseTimeOfArrival();
+
+	/*
+	 * Attributes of most recent transmitStaticSynchronously().
+	 * Time the address was on air (captured on ADDRESS event while spinning.)
+	 * Sender can use it to correct a timestamp in a follow-up packet.
+	 */
+	static LongTime timeOfTransmit();
+	static PreciseTime preciseTimeOfTransmit();
+
+	/*
+	 * Stamper, if not nullptr, is called immediately before each transmit starts,
+	 * to write current time into packet.
+	 * Then the error in the timestamp is only the constant rampup, not the caller's code path.
+	 */
+	static void setTransmitStamper(TransmitStamper stamper);
+	static TransmitStamper transmitStamper();
     static unsigned int receivedSignalStrength();
 
+	/*
+	 * Counters since POR or resetStatistics().
+	 */
+	static const RadioStatistics& statistics();
+	static void resetStatistics();
+	// Via RTTLogger, impotent unless LOGGING
+	static void logStatistics();
+
 
 // FUTURE to anon namespace
 private:
@@ -291,4 +403,16 @@ private:
 	static void disableInterruptForEndTransmit();
 
 	static void transmitStatic();
+	static void spinUntilAddressTransmitted();
+	// receiveStatic() without counting a new window
+	static void restartReceive();
+#ifdef RSSI_TASK_IS_REAL
+	static uint8_t sampleChannelEnergy(uint8_t frequencyIndex, OSTime dwell);
+#endif
+
+	static void recoverFromUnexpectedEvent();
+	static void transmitAckIfRequested();
+
+	// Accumulate time since onSince into an on-time statistic
+	static void accumulateOnTime(LongTime& onTime);
 };
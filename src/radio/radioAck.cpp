@@ -0,0 +1,125 @@
+#include <cassert>
+
+#include "radio.h"
+#include "radioData.h"
+
+
+/*
+ * Acknowledged transfer.
+ *
+ * Ack uses its own buffer, so that:
+ * - receiver keeps the received packet while it transmits the ack
+ * - sender keeps the sent packet (to retransmit and to match) while it receives the ack
+ *
+ * Not using device shortcuts DISABLED->TXEN (receiver) and END->RXEN (sender):
+ * the device API sets one fixed set of shortcuts, and the ack must come from another buffer.
+ * Instead, turnaround is done by the mcu, spinning.
+ * Both sides spin only for one ack (rampup plus airtime, roughly 100 uSec.)
+ */
+
+
+using namespace RadioData;
+
+
+volatile uint8_t RadioData::ackBuffer[Radio::FixedPayloadCount];
+AckMaker RadioData::anAckMaker = nullptr;
+AckMatcher RadioData::anAckMatcher = nullptr;
+
+
+namespace {
+
+/*
+ * Point DMA at ack buffer.
+ * Legal any time radio is disabled.  Next operation restores DMA to radioBuffer (setupFixedDMA())
+ */
+void setupAckDMA() {
+	device.configurePacketAddress(ackBuffer);
+}
+
+}	// namespace
+
+
+
+void Radio::setAckHandlers(AckMaker maker, AckMatcher matcher) {
+	anAckMaker = maker;
+	anAckMatcher = matcher;
+}
+
+bool Radio::isAckMode() { return anAckMaker != nullptr; }
+
+
+/*
+ * In radioISR, after a packet with valid CRC.
+ * Radio is disabled.
+ */
+void Radio::transmitAckIfRequested() {
+	assert(device.isDisabledState());
+
+	if (not anAckMaker(radioBuffer, ackBuffer)) return;
+
+	RadioData::statistics.acksSent++;
+
+	/*
+	 * Spin on the ack, not interrupt.
+	 * Else DISABLED at end of ack pends RADIO_IRQ while this radioISR is active,
+	 * and clearing the event does not unpend it: radioISR is entered again, as if spurious.
+	 * With the interrupt disabled in the device, the ack's DISABLED event does not reach the NVIC.
+	 */
+	disableInterruptForMsgReceived();
+
+	onSince = LongClock::nowTimeISRSafe();
+	setupAckDMA();
+	startTXTask();
+	spinUntilDisabled();
+	accumulateOnTime(RadioData::statistics.txOnTime);
+
+	// Restore interrupt, clearing the ack's event
+	setupInterruptForMsgReceivedEvent();
+}
+
+
+bool Radio::transmitWithAck(unsigned int maxAttempts, OSTime ackTimeout) {
+	assert(anAckMatcher != nullptr);
+	assert(maxAttempts > 0);
+
+	for (unsigned int attempt = 0; attempt < maxAttempts; attempt++) {
+		if (attempt > 0) RadioData::statistics.ackRetries++;
+
+		transmitStaticSynchronously();
+
+		// Receive ack spinning, not by interrupt
+		assert(not isEnabledInterruptForMsgReceived());
+		RadioData::state = Receiving;
+		onSince = LongClock::nowTimeISRSafe();
+		setupAckDMA();
+		startRcv();
+
+		LongTime deadline = onSince + ackTimeout;
+		/*
+		 * Radio stays in DISABLED state briefly after the RXEN task.
+		 * Wait for RXRU, else the state would be mistaken for a packet received.
+		 * Then poll the DISABLED event (cleared by startRcv()) not the state.
+		 */
+		while (device.isDisabledState() and LongClock::nowTime() < deadline) {}
+		while (not isEventForMsgReceivedInterrupt() and LongClock::nowTime() < deadline) {}
+
+		bool isAcked = false;
+		if (not isEventForMsgReceivedInterrupt()) {
+			// Timeout: no ack
+			device.startDisablingTask();
+			spinUntilDisabled();
+		}
+		else {
+			// Received something, maybe not our ack
+			isAcked = device.isCRCValid() and anAckMatcher(radioBuffer, ackBuffer);
+		}
+
+		accumulateOnTime(RadioData::statistics.rxOnTime);
+		clearEventForMsgReceivedInterrupt();
+		RadioData::state = Idle;
+		if (isAcked) return true;
+	}
+
+	RadioData::statistics.ackFailures++;
+	return false;
+}
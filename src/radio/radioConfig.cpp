@@ -30,6 +30,8 @@ using namespace RadioData;
 namespace {
 // Remember distinct signature of radio configuration for SleepSync protocol
 uint32_t configuredSignature;
+
+uint8_t _frequencyIndex = Radio::FrequencyIndex;
 }
 
 
@@ -40,7 +42,7 @@ void Radio::configurePhysicalProtocol() {
 
 
 	// Specific to the protocol, here rawish
-	RadioData::device.configureFixedFrequency(FrequencyIndex);
+	RadioData::device.configureFixedFrequency(_frequencyIndex);
 	device.configureFixedLogicalAddress();
 	device.configureNetworkAddressPool();
 #ifdef LONG_MESSAGE
@@ -70,7 +72,7 @@ void Radio::configurePhysicalProtocol() {
 	configuredSignature = device.configurationSignature();
 
 	// Default mode i.e. bits per second
-	assert(device.frequency() == FrequencyIndex);
+	assert(device.frequency() == _frequencyIndex);
 }
 
 
@@ -84,6 +86,17 @@ bool Radio::isConfiguredForSleepSync() {
 }
 
 
+void Radio::setFrequencyIndex(uint8_t index) {
+	assert(index <= MaxFrequencyIndex);
+
+	_frequencyIndex = index;
+	// Signature changes with frequency
+	configurePhysicalProtocol();
+}
+
+uint8_t Radio::frequencyIndex() { return _frequencyIndex; }
+
+
 void Radio::configureXmitPower(TransmitPowerdBm dBm) {
 	// Radio not configurable while in use
 	assert(!isInUse());
@@ -95,6 +108,19 @@ void Radio::configureXmitPower(TransmitPowerdBm dBm) {
 
 
 
+/*
+ * Compare to device register, not to a shadow: correct even if configuration was lost.
+ * Register read is cheaper than write (which would also be legal.)
+ */
+void Radio::configureXmitPowerIfChanged(TransmitPowerdBm dBm) {
+	int8_t raw = XmitPower::rawXmitPower(dBm);
+	if (device.getXmitPower() != raw) {
+		assert(!isInUse());
+		device.configureXmitPower(raw);
+	}
+}
+
+
 TransmitPowerdBm Radio::getXmitPower() {
 	return XmitPower::xmitPowerFromRaw(device.getXmitPower());
 	// OLD return static_cast<TransmitPowerdBm> (device.getXmitPower());
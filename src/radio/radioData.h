@@ -6,6 +6,8 @@
 // platform lib e.g. nRF5x
 #include <drivers/radio/radio.h>
 
+#include "radioStatistics.h"
+
 /*
  * Data (not a class) associated with Radio but not kept by RadioDevice.
  */
@@ -17,12 +19,27 @@ extern RadioDevice device;
 // App's callback
 extern void (*aRcvMsgCallback)();	// = nullptr;
 
+// Whether callback is posted to EventQueue instead of called from ISR
+extern bool isRcvMsgCallbackDeferred;
+
 // timestamp of packet
 extern LongTime _timeOfArrival;
+// valid if LongClock::isPreciseMode() when packet arrived
+extern PreciseTime _preciseTimeOfArrival;
+
+// timestamp of ADDRESS on air, for most recent transmitStaticSynchronously()
+extern LongTime _timeOfTransmit;
+extern PreciseTime _preciseTimeOfTransmit;
+extern TransmitStamper aTransmitStamper;	// = nullptr
 
 // used for assertions
 extern RadioState state;
 
+// Always on counters, see radioStatistics.h
+extern RadioStatistics statistics;
+// When current RX or TX began, for statistics
+extern LongTime onSince;
+
 /*
  * Buffer R/W by concurrent radio HW (volatile) using DMA.
  * No guards around buffer.
@@ -31,4 +48,12 @@ extern RadioState state;
  */
 extern volatile uint8_t radioBuffer[Radio::FixedPayloadCount];
 
+/*
+ * Ack mode, see radioAck.cpp.
+ * Ack is fixed length like every packet.
+ */
+extern volatile uint8_t ackBuffer[Radio::FixedPayloadCount];
+extern AckMaker anAckMaker;
+extern AckMatcher anAckMatcher;
+
 }
@@ -0,0 +1,123 @@
+#include <cassert>
+
+#include "radio.h"
+#include "radioData.h"
+
+
+/*
+ * Spectrum scan: energy per channel by sampling RSSI.
+ *
+ * Receives (without interrupt) on each channel for dwell,
+ * sampling RSSI repeatedly, keeping the strongest sample.
+ * Receive uses the usual shortcuts: a packet on the channel disables the radio, and receive is restarted.
+ * Device reports RSSI as magnitude of negative dBm: larger is quieter.
+ *
+ * Restores the configured frequency afterwards.
+ */
+
+
+#ifdef RSSI_TASK_IS_REAL
+
+using namespace RadioData;
+
+
+namespace {
+
+/*
+ * Ticks from start RX task until device is receiving (RXRU done.)
+ * Rampup is 40 uSec (fast) or 130 uSec: 5 ticks is ample.
+ */
+const OSTime RampupTicks = 5;
+
+/*
+ * Quietest possible value.  Device RSSISAMPLE is 7 bits.
+ */
+const uint8_t QuietestRSSI = 127;
+
+
+void spinTicks(OSTime ticks) {
+	LongTime end = LongClock::nowTime() + ticks;
+	while (LongClock::nowTime() < end) {}
+}
+
+}	// namespace
+
+
+
+uint8_t Radio::sampleChannelEnergy(uint8_t frequencyIndex, OSTime dwell) {
+	device.configureFixedFrequency(frequencyIndex);
+
+	// Receive spinning, not by interrupt
+	assert(not isEnabledInterruptForMsgReceived());
+	state = Receiving;
+	startRcv();
+	spinTicks(RampupTicks);
+
+	uint8_t result = QuietestRSSI;
+	LongTime dwellEnd = LongClock::nowTime() + dwell;
+	do {
+		if (device.isDisabledState()) {
+			// Packet received (shortcut disabled radio): receive again
+			clearEventForMsgReceivedInterrupt();
+			startRcv();
+			spinTicks(RampupTicks);
+			continue;
+		}
+
+		device.startRSSIMeasurement();
+		// RSSIEND never comes if a packet disables radio meanwhile
+		while (not device.isRSSIMeasurementDone() and not device.isDisabledState()) {}
+		if (device.isRSSIMeasurementDone()) {
+			uint8_t sample = (uint8_t) device.receivedSignalStrength();
+			if (sample < result) result = sample;
+		}
+	}
+	while (LongClock::nowTime() < dwellEnd);
+
+	// Disable, clear event a packet might have caused, leave as found
+	if (not device.isDisabledState()) {
+		device.startDisablingTask();
+		spinUntilDisabled();
+	}
+	clearEventForMsgReceivedInterrupt();
+	state = Idle;
+	return result;
+}
+
+
+void Radio::scanChannels(uint8_t firstIndex, uint8_t lastIndex, OSTime dwell, uint8_t* energyMap) {
+	assert(firstIndex <= lastIndex);
+	assert(lastIndex <= MaxFrequencyIndex);
+	assert(not isInUse());
+
+	// Left enabled by radioISR after a packet.  Enabled again by next receiveStatic()
+	disableInterruptForMsgReceived();
+
+	for (unsigned int index = firstIndex; index <= lastIndex; index++) {
+		energyMap[index - firstIndex] = sampleChannelEnergy(index, dwell);
+	}
+	device.configureFixedFrequency(frequencyIndex());
+}
+
+
+uint8_t Radio::quietestChannel(const uint8_t* candidates, uint8_t count, OSTime dwell) {
+	assert(count > 0);
+	assert(not isInUse());
+
+	disableInterruptForMsgReceived();
+
+	uint8_t result = candidates[0];
+	uint8_t quietest = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		assert(candidates[i] <= MaxFrequencyIndex);
+		uint8_t energy = sampleChannelEnergy(candidates[i], dwell);
+		if (energy > quietest) {
+			quietest = energy;
+			result = candidates[i];
+		}
+	}
+	device.configureFixedFrequency(frequencyIndex());
+	return result;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <inttypes.h>
+
+// embeddedMath
+#include <timeTypes.h>	// LongTime
+
+
+/*
+ * Counters of radio behaviour, to find where radio energy goes.
+ *
+ * Always on (not conditional on LOGGING.)
+ * Kept by Radio: each increment is a load, add, store.
+ * Counters wrap (32-bit.)  Times are in ticks of LongClock.
+ *
+ * Read via Radio::statistics(), dump via Radio::logStatistics().
+ */
+struct RadioStatistics {
+	// Packets received: radioISR with MsgReceived event, valid or invalid CRC
+	uint32_t received;
+	// Subset of received
+	uint32_t crcFailures;
+	// radioISR without MsgReceived event (recovered, formerly assert)
+	uint32_t spuriousInterrupts;
+	// Subset of spurious, when configuration was also found corrupted
+	uint32_t reconfigurations;
+
+	// receiveStatic() calls
+	uint32_t rxWindowsOpened;
+	// Windows closed by stopReceive() without receiving a packet
+	uint32_t rxWindowsEmpty;
+	// stopReceive() while a packet was arriving (address matched)
+	uint32_t abortsMidPacket;
+
+	uint32_t transmitted;
+
+	// Ack mode
+	uint32_t acksSent;
+	uint32_t ackRetries;
+	// transmitWithAck() exhausted attempts
+	uint32_t ackFailures;
+
+	// Cumulative time radio was enabled
+	LongTime rxOnTime;
+	LongTime txOnTime;
+};
@@ -6,13 +6,24 @@
 #include <clock/longClock.h>
 #include <clock/clockFacilitator.h>
 #include <clock/clockDuration.h>
+#include <clock/networkClock.h>
+#include <clock/idleScheduler.h>
 
 #include "services/mailbox.h"
+#include "services/ringMailbox.h"
+#include "services/eventQueue.h"
 
 #include "services/ledFlasherTask.h"
 
 #include "ensemble/ensemble.h"
+#include "ensemble/lowPowerListener.h"
+#include "ensemble/floodRelay.h"
+#include "ensemble/transmitQueue.h"
+#include "ensemble/radioArbiter.h"
 #include "radio/radio.h"
+#include "radio/messageView.h"
+#include "radio/duplicateFilter.h"
+#include "radio/linkQualityTable.h"
 
 #include "modules/powerManager.h"
 #include "modules/ledService.h"
@@ -30,3 +30,5 @@ TransmitPowerdBm RadioUseCase::getXmitPower() {
 	// !!! return value from device
 	return Radio::getXmitPower();
 }
+
+TransmitPowerdBm RadioUseCase::defaultXmitPower() { return power; }
@@ -46,4 +46,10 @@ public:
 
 	// Returns xmit power from device, not any memoized value
 	static TransmitPowerdBm getXmitPower();
+
+	/*
+	 * Returns memoized value: power for a transmit that does not specify one.
+	 * May differ from device after a per-packet power (see Ensemble.)
+	 */
+	static TransmitPowerdBm defaultXmitPower();
 };
@@ -0,0 +1,61 @@
+
+#include <cassert>
+
+#include "eventQueue.h"
+#include "ringMailbox.h"
+
+
+/*
+ * This implementation: one RingMailbox per priority level,
+ * each with one producer and one consumer.
+ */
+
+
+namespace {
+
+RingMailbox<Task, EventQueue::Capacity> rings[EventQueue::CountPriorities];
+
+}	// namespace
+
+
+
+bool EventQueue::post(Task task, EventPriority priority) {
+	assert(task != nullptr);
+
+	return rings[static_cast<unsigned int>(priority)].tryPut(task);
+}
+
+
+bool EventQueue::dispatchOne() {
+	for (unsigned int level = 0; level < CountPriorities; level++) {
+		if (rings[level].isMail()) {
+			// Fetch frees the slot before calling, so task may post again
+			Task task = rings[level].fetch();
+			task();
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void EventQueue::dispatchAll() {
+	while (dispatchOne()) {}
+}
+
+
+bool EventQueue::isEmpty() {
+	for (unsigned int level = 0; level < CountPriorities; level++) {
+		if (rings[level].isMail()) return false;
+	}
+	return true;
+}
+
+
+uint32_t EventQueue::countOverflows() {
+	uint32_t result = 0;
+	for (unsigned int level = 0; level < CountPriorities; level++) {
+		result += rings[level].countOverflows();
+	}
+	return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../clock/taskTimer.h"	// Task
+
+
+/*
+ * Priority of work posted to EventQueue.
+ *
+ * Each level is a single-producer queue: post to a level from only one interrupt priority.
+ * By convention:
+ * - High: radioISR
+ * - Normal: timerISR (TaskTimer)
+ * - Low: thread mode, or any other one ISR
+ */
+enum class EventPriority {
+	High = 0,
+	Normal,
+	Low
+};
+
+
+/*
+ * Run-to-completion queue of deferred work.
+ *
+ * ISRs post a Task and return quickly.
+ * Thread mode dispatches posted Tasks, highest priority first, each to completion.
+ * (IdleScheduler dispatches before it sleeps.)
+ *
+ * Lock-free: no critical sections, interrupts are never masked.
+ * Statically sized: post fails when a level is full, and the overflow is counted.
+ *
+ * Pure class, no instances.
+ */
+class EventQueue {
+public:
+	static const unsigned int CountPriorities = 3;
+
+	// Per priority level.  Power of two (see RingMailbox)
+	static const unsigned int Capacity = 8;
+
+	/*
+	 * From ISR or thread mode, see EventPriority re single producer.
+	 * Returns false if level is full (task will not be called.)
+	 */
+	static bool post(Task task, EventPriority priority);
+
+	/*
+	 * From thread mode only (single consumer.)
+	 *
+	 * Call the highest priority Task posted.
+	 * Returns false if none.
+	 */
+	static bool dispatchOne();
+
+	/*
+	 * Until empty, including Tasks posted while dispatching.
+	 */
+	static void dispatchAll();
+
+	static bool isEmpty();
+
+	// Count of Tasks not posted because full
+	static uint32_t countOverflows();
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <inttypes.h>
+#include <cassert>
+
+
+/*
+ * Mailbox holding up to Capacity items of type T, in FIFO order.
+ *
+ * Unlike Mailbox:
+ * - generic on type of item
+ * - holds many items, so a burst from an ISR is not lost
+ * - safe between one producer and one consumer at different interrupt priorities (e.g. ISR and thread mode)
+ *
+ * Lock-free: no critical sections.
+ * Each index is written by only one side:
+ * - producer writes tail
+ * - consumer writes head
+ * Memory barriers order slot contents w.r.t. the index that publishes them.
+ * Correct on Cortex-M0 (no LDREX/STREX needed) and Cortex-M4.
+ *
+ * Capacity must be a power of two.
+ * Indexes are free-running (wrap modulo 256) and masked to a slot, so no slot is wasted.
+ *
+ * Cost, unmeasured estimate (counted from the instruction sequence, not timed on a target):
+ * tryPut and fetch are each a few loads and stores plus one DMB.
+ * Expect them to be somewhat slower than Mailbox, which has no barrier (and is not safe from an ISR.)
+ * To measure, read DWT CYCCNT (M4 only) around calls.
+ *
+ * Statically configured to empty.
+ * Algebra:
+ * reset; isMail() == false
+ * tryPut() == true; isMail() == true; fetch(); isMail() == false
+ */
+template <typename T, unsigned int Capacity>
+class RingMailbox {
+	static_assert(Capacity > 0 and (Capacity & (Capacity - 1)) == 0, "Capacity must be power of two");
+	static_assert(Capacity <= 128, "Capacity must fit in free-running uint8_t indexes");
+
+	static const uint8_t Mask = Capacity - 1;
+
+	T slots[Capacity];
+	volatile uint8_t head = 0;	// next to fetch, written only by consumer
+	volatile uint8_t tail = 0;	// next to put, written only by producer
+
+	volatile uint32_t overflows = 0;	// written only by producer
+
+	/*
+	 * Also a compiler barrier.
+	 */
+	static void memoryBarrier() { __sync_synchronize(); }
+
+	uint8_t count() const { return (uint8_t) (tail - head); }
+
+public:
+	/*
+	 * Producer side.
+	 * Does nothing if isFull, and counts an overflow.
+	 */
+	bool tryPut(const T& item) {
+		uint8_t currentTail = tail;
+		if ((uint8_t) (currentTail - head) == Capacity) {
+			overflows++;
+			return false;
+		}
+		slots[currentTail & Mask] = item;
+		memoryBarrier();	// slot written before published
+		tail = currentTail + 1;
+		return true;
+	}
+
+	/*
+	 * Consumer side.
+	 */
+
+	// fetch first mail in box
+	T fetch() {
+		assert(isMail());	// require
+
+		uint8_t currentHead = head;
+		memoryBarrier();	// tail read before slot
+		T result = slots[currentHead & Mask];
+		memoryBarrier();	// slot read before freed
+		head = currentHead + 1;
+		return result;
+	}
+
+	// first mail in box, not removed
+	const T& peek() const {
+		assert(isMail());	// require
+		memoryBarrier();
+		return slots[head & Mask];
+	}
+
+	/*
+	 * Fetch and pass to handler every item, including items put while draining.
+	 * Returns count drained.
+	 */
+	template <typename Handler>
+	unsigned int drainAll(Handler handler) {
+		unsigned int result = 0;
+		while (isMail()) {
+			handler(fetch());
+			result++;
+		}
+		return result;
+	}
+
+	/*
+	 * Either side, but result may be stale when used.
+	 */
+	bool isMail() const { return count() != 0; }
+	bool isFull() const { return count() == Capacity; }
+	unsigned int countItems() const { return count(); }
+
+	// Count of items not put because full
+	uint32_t countOverflows() const { return overflows; }
+};